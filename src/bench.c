@@ -0,0 +1,388 @@
+/***************************************************************************/
+
+/* Program concept and description :                                       *
+ * Benchmark of the bfs library. Generates open fields, perfect mazes,     *
+ * long winding corridors and random mazes over a sweep of densities, at   *
+ * each size asked for, and solves each with every engine asked for. Each  *
+ * case runs in a child process of its own, so that its peak resident set  *
+ * is its own, and reports the best wall time of each phase over its       *
+ * repetitions: parsing the text, traversing the maze and rendering every  *
+ * stage. Results are written to stdout, one line per case, as CSV with a  *
+ * header or as JSON objects                                               */
+
+/***************************************************************************/
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "bfs.h"
+
+/* Command line usage */
+#define USAGE "usage: %s [-e engines] [-k kinds] [-n sizes] [-r reps]" \
+              " [-j threads] [-s seed] [-J]\n"
+#define OPTIONS "e:k:n:r:j:s:J"
+
+/* Maze kinds, named by KINDS in the same order */
+#define OPENFIELD 0
+#define PERFECT   1
+#define CORRIDOR  2
+#define RANDOM    3
+#define KINDS     {"open", "perfect", "corridor", "random", NULL}
+
+/* Percentages of open cells swept by random mazes, ending in NIL */
+#define DENSITIES {50, 60, 70, 80, 90, NIL}
+
+/* Defaults. Mazes are square, SIZES cells a side, the smallest MINSIZE */
+#define SIZES    "10,100,1000,3000"
+#define MINSIZE  3
+#define REPS     3
+#define SEED     0x9e3779b97f4a7c15ULL
+
+/* Engines bfs_engine takes, by name */
+#define ENGINES   {"queue", "bitboard", "hybrid", "bidir", "parallel", \
+                   "tiled", "astar", "jps", NULL}
+
+/* Characters of the maze text */
+#define NEWLINE   '\n'
+#define WALL      '#'
+#define PATH      '.'
+
+/* Directions carved, in the order they are tried */
+#define RIGHT     0
+#define DOWN      1
+#define LEFT      2
+#define UP        3
+
+/* Miscellaneous Constants */
+#define NOTVISIT  - 1
+#define TRUE      1
+#define NIL       0
+
+/* Result formats */
+#define CSVHEAD  "kind,density,rows,cols,engine,read_ms,traverse_ms," \
+                 "print_ms,cells_per_sec,cost,rss_kb\n"
+#define CSVROW   "%s,%d,%d,%d,%s,%.3f,%.3f,%.3f,%.0f,%d,%ld\n"
+#define JSONROW  "{\"kind\":\"%s\",\"density\":%d,\"rows\":%d,\"cols\":%d," \
+                 "\"engine\":\"%s\",\"read_ms\":%.3f,\"traverse_ms\":%.3f," \
+                 "\"print_ms\":%.3f,\"cells_per_sec\":%.0f,\"cost\":%d," \
+                 "\"rss_kb\":%ld}\n"
+
+/***************************************************************************/
+
+/* Structure naming convention */
+typedef struct bench_s bench_t;
+
+/* Benchmark structure */
+struct bench_s {
+	int      engines; /* Bit of each engine run   */
+	int      kinds; /* Bit of each kind generated */
+	int     *sizes; /* Side of each maze size     */
+	int      nsizes; /* Number of sizes           */
+	int      reps;  /* Solves of each case        */
+	int      threads; /* Threads of parallel engine */
+	int      json;  /* Write JSON, not CSV        */
+	uint64_t seed;  /* Seed of the generator      */
+};
+
+/***************************************************************************/
+
+/* Function prototypes */
+void    read_bench(bench_t *bench, int argc, char **argv);
+int     read_names(char *list, const char **names, char *prog);
+void    read_sizes(bench_t *bench, char *list, char *prog);
+char   *new_text(bench_t *bench, int kind, int density, int n);
+void    carve_maze(bench_t *bench, char *text, int n);
+uint64_t next_rand(uint64_t *state);
+void    run_case(bench_t *bench, char *text, int n, int kind, int density,
+		int engine);
+void    time_case(bench_t *bench, char *text, int n, int kind, int density,
+		int engine);
+double  now_ms();
+
+/***************************************************************************/
+
+/* Runs every case the options ask for, size by size */
+int main(int argc, char **argv) {
+	bench_t bench;
+	const int densities[] = DENSITIES;
+	const char *engines[] = ENGINES;
+	int i, kind, engine, d;
+	char *text;
+	read_bench(&bench, argc, argv);
+	if (!bench.json) {
+		printf(CSVHEAD);
+		fflush(stdout);
+	}
+	for (i = NIL; i < bench.nsizes; i++) {
+		for (kind = OPENFIELD; kind <= RANDOM; kind++) {
+			if (!(bench.kinds & 1 << kind)) {
+				continue;
+			}
+			for (d = NIL; kind == RANDOM ? densities[d] : !d; d++) {
+				text = new_text(&bench, kind, densities[d], bench.sizes[i]);
+				for (engine = NIL; engines[engine]; engine++) {
+					if (bench.engines & 1 << engine) {
+						run_case(&bench, text, bench.sizes[i], kind,
+								kind == RANDOM ? densities[d] : 100, engine);
+					}
+				}
+				free(text);
+			}
+		}
+	}
+	free(bench.sizes);
+	return EXIT_SUCCESS;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Parses command line options. -e and -k take comma separated engines *
+ * and kinds (all of each by default), -n the sides of the mazes, -r   *
+ * the solves of each case, -j the threads of the parallel engine (one *
+ * per processor by default), -s the seed of the generator and -J asks *
+ * for JSON                                                            */
+void read_bench(bench_t *bench, int argc, char **argv) {
+	int c;
+	const char *engines[] = ENGINES, *kinds[] = KINDS;
+	char sizes[] = SIZES;
+	memset(bench, NIL, sizeof(*bench));
+	bench->engines = bench->kinds = ~NIL;
+	bench->reps = REPS;
+	bench->threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	bench->seed = SEED;
+	read_sizes(bench, sizes, argv[0]);
+	while ((c = getopt(argc, argv, OPTIONS)) != - 1) {
+		switch (c) {
+			case 'e':
+				bench->engines = read_names(optarg, engines, argv[0]);
+				break;
+			case 'k':
+				bench->kinds = read_names(optarg, kinds, argv[0]);
+				break;
+			case 'n':
+				read_sizes(bench, optarg, argv[0]);
+				break;
+			case 'r':
+				if ((bench->reps = atoi(optarg)) < 1) {
+					fprintf(stderr, USAGE, argv[0]);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'j':
+				if ((bench->threads = atoi(optarg)) < 1) {
+					bench->threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+				}
+				break;
+			case 's':
+				bench->seed = strtoull(optarg, NULL, 0) | 1;
+				break;
+			case 'J':
+				bench->json = TRUE;
+				break;
+			default:
+				fprintf(stderr, USAGE, argv[0]);
+				exit(EXIT_FAILURE);
+		}
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Returns a bit for each comma separated name of the list, by its place *
+ * in names                                                              */
+int read_names(char *list, const char **names, char *prog) {
+	int i, bits = NIL;
+	char *name;
+	for (name = strtok(list, ","); name; name = strtok(NULL, ",")) {
+		for (i = NIL; names[i] && strcmp(names[i], name); i++);
+		if (!names[i]) {
+			fprintf(stderr, USAGE, prog);
+			exit(EXIT_FAILURE);
+		}
+		bits |= 1 << i;
+	}
+	return bits;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Replaces the sizes with the comma separated sides of the list */
+void read_sizes(bench_t *bench, char *list, char *prog) {
+	char *side;
+	bench->nsizes = NIL;
+	for (side = strtok(list, ","); side; side = strtok(NULL, ",")) {
+		bench->sizes = (int *)realloc(bench->sizes,
+				(bench->nsizes + 1) * sizeof(*(bench->sizes)));
+		assert(bench->sizes);
+		if ((bench->sizes[bench->nsizes++] = atoi(side)) < MINSIZE) {
+			fprintf(stderr, USAGE, prog);
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Generates the text of an n by n maze of a kind. Corridors wind back and *
+ * forth across every other row, so the one path visits half the cells.    *
+ * Random mazes open each cell with the density given, in percent          */
+char *new_text(bench_t *bench, int kind, int density, int n) {
+	int x, y;
+	size_t w = (size_t)n + 1;
+	uint64_t state = bench->seed ^ ((uint64_t)kind << 32 | density) * n;
+	char *text = (char *)malloc(w * n), *row;
+	assert(text);
+	for (x = NIL; x < n; x++) {
+		row = text + x * w;
+		row[n] = NEWLINE;
+		for (y = NIL; y < n; y++) {
+			switch (kind) {
+				case OPENFIELD:
+					row[y] = PATH;
+					break;
+				case CORRIDOR:
+					row[y] = x % 2 ? (y && y < n - 1 ? PATH : WALL) :
+						y == (x && x / 2 % 2 ? n - 2 : 1) ? PATH : WALL;
+					break;
+				case RANDOM:
+					row[y] = (int)(next_rand(&state) % 100) < density ?
+						PATH : WALL;
+					break;
+				default:
+					row[y] = WALL;
+			}
+		}
+	}
+	if (kind == PERFECT) {
+		carve_maze(bench, text, n);
+	}
+	return text;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Carves a perfect maze, one path between any two cells, into a maze of  *
+ * walls by a depth first walk kept on an explicit stack. Cells lie at    *
+ * odd rows and columns; the entrance is above the first and the exit     *
+ * runs down from the first of the last row of cells                      */
+void carve_maze(bench_t *bench, char *text, int n) {
+	int x, y, dir, next, dirs, top = NIL, h = (n - 1) / 2, w = (n - 1) / 2;
+	int *stack = (int *)malloc((size_t)h * w * sizeof(*stack));
+	size_t width = (size_t)n + 1;
+	uint64_t state = bench->seed;
+	assert(stack);
+	text[1] = text[width + 1] = PATH;
+	stack[top++] = NIL;
+	while (top) {
+		x = stack[top - 1] / w;
+		y = stack[top - 1] % w;
+		for (dirs = NIL, dir = RIGHT; dir <= UP; dir++) {
+			next = dir == RIGHT ? (y + 1 < w ? x * w + y + 1 : NOTVISIT) :
+				dir == DOWN ? (x + 1 < h ? (x + 1) * w + y : NOTVISIT) :
+				dir == LEFT ? (y ? x * w + y - 1 : NOTVISIT) :
+				(x ? (x - 1) * w + y : NOTVISIT);
+			if (next != NOTVISIT && text[(next / w * 2 + 1) * width +
+					next % w * 2 + 1] == WALL) {
+				dirs |= 1 << dir;
+			}
+		}
+		if (!dirs) {
+			top--;
+			continue;
+		}
+		do {
+			dir = (int)(next_rand(&state) % 4);
+		} while (!(dirs & 1 << dir));
+		next = dir == RIGHT ? x * w + y + 1 : dir == DOWN ? (x + 1) * w + y :
+			dir == LEFT ? x * w + y - 1 : (x - 1) * w + y;
+		text[(x + next / w + 1) * width + y + next % w + 1] = PATH;
+		text[(next / w * 2 + 1) * width + next % w * 2 + 1] = PATH;
+		stack[top++] = next;
+	}
+	for (x = h * 2; x < n; x++) {
+		text[x * width + 1] = PATH;
+	}
+	free(stack);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Steps a xorshift generator */
+uint64_t next_rand(uint64_t *state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Times one case in a child process and waits for it to write its line */
+void run_case(bench_t *bench, char *text, int n, int kind, int density,
+		int engine) {
+	pid_t pid = fork();
+	if (pid < NIL) {
+		perror("fork");
+		exit(EXIT_FAILURE);
+	}
+	if (!pid) {
+		time_case(bench, text, n, kind, density, engine);
+		exit(EXIT_SUCCESS);
+	}
+	waitpid(pid, NULL, NIL);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Parses, traverses and renders the maze as many times as asked, keeping *
+ * the best time of each phase, then writes them with the peak resident   *
+ * set of the process                                                     */
+void time_case(bench_t *bench, char *text, int n, int kind, int density,
+		int engine) {
+	const char *engines[] = ENGINES, *kinds[] = KINDS;
+	double t, best[3] = {NOTVISIT, NOTVISIT, NOTVISIT}, lap[3];
+	struct rusage usage;
+	bfs_t *bfs = bfs_new();
+	int i, j;
+	char sink;
+	bfs_engine(bfs, engines[engine]);
+	bfs_threads(bfs, bench->threads);
+	for (i = NIL; i < bench->reps; i++) {
+		t = now_ms();
+		bfs_load(bfs, text, ((size_t)n + 1) * n);
+		lap[0] = now_ms() - t;
+		bfs_solve(bfs);
+		lap[1] = now_ms() - t - lap[0];
+		bfs_render(bfs, BFS_STAGES, &sink, sizeof(sink));
+		lap[2] = now_ms() - t - lap[0] - lap[1];
+		for (j = NIL; j < 3; j++) {
+			if (best[j] < NIL || lap[j] < best[j]) {
+				best[j] = lap[j];
+			}
+		}
+	}
+	getrusage(RUSAGE_SELF, &usage);
+	printf(bench->json ? JSONROW : CSVROW, kinds[kind], density, n, n,
+			engines[engine], best[0], best[1], best[2],
+			(double)n * n / (best[1] > NIL ? best[1] : 1e-3) * 1e3,
+			bfs_cost(bfs), usage.ru_maxrss);
+	fflush(stdout);
+	bfs_free(bfs);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Milliseconds on the monotonic clock */
+double now_ms() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/***************************************************************************/
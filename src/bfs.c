@@ -1,515 +1,3778 @@
-/***************************************************************************/
-
-/* Program concept and description :                                       *
- * Breadth First Search implementation of maze traversing.                 *
- * Uses a queue (linked-list) with which each node stores a parent pointer *
- * to enable the queue to also perform as a cost-leveled tree, with maze   *
- * entrances as the roots. The exit with the lowest cost is determined     *
- * after all cells have been traversed and the shortest leftmost path is   *
- * constructed via following parent pointers back to the root.             *
- * Nodes are initialised with cost -1 as an indication of not visited      */
-
-/***************************************************************************/
-
-#include <assert.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-
-/* Maximum maze size */
-#define MAX_ROWS 100
-#define MAX_COLS 100
-
-/* Cell character types */
-#define NEWLINE     '\n'
-#define WALL        '#'
-#define PATH        '.'
-#define REACHABLE   '+'
-#define UNREACHABLE '-'
-#define NONSOLUTION ' '
-
-/* Miscellaneous Constants */
-#define NOTVISIT  - 1
-#define TRUE        1
-#define FALSE       0
-#define NIL         0
-#define LAST_ROW    maze->rows - 1
-#define LAST_COL    maze->cols - 1
-
-/* Stage numbers */
-#define STAGE1 1
-#define STAGE2 2
-#define STAGE3 3
-#define STAGE4 4
-
-/* Printing related constants */
-#define STAGENUM "Stage %d\n=======\n"
-#define PRINT1   "maze has %d rows and %d columns\n"
-#define PRINT2A  "maze has a solution\n"
-#define PRINT2B  "maze has no solution\n"
-#define PRINT3A  "maze has solution with cost %d\n"
-#define PRINT3B  "maze has no solution\n"
-#define PRINT4   "maze solution\n"
-#define ONEDIGIT "0%1d"
-#define TWODIGIT "%2d"
-#define ONECHAR  "%c"
-#define TWOCHAR  "%c%c"
-
-/***************************************************************************/
-
-/* Structure naming convention */
-typedef struct maze_s maze_t;
-typedef struct cell_s cell_t;
-typedef struct list_s list_t;
-
-/* Cell structure */
-struct cell_s {
-	int  x;         /* x-coordinate               */
-	int  y;         /* y-coordinate               */
-	int  cost;      /* Cost from nearest entrance */
-	int  reach;     /* Reachability of cell       */
-	int  soln;      /* Part of shortest path      */
-	char type;      /* Cell visualisation         */
-};
-
-/* Maze structure */
-struct maze_s {
-	int      rows;  /* Number of rows             */
-	int      cols;  /* Number of columns          */
-	int      cost;  /* Lowest cost of solution    */
-	int      soln;  /* Maze has a solution        */
-	cell_t **cells; /* 2D Array of cells          */
-};
-
-/* List structure */
-struct list_s {
-	cell_t *cell;   /* Corresponding cell in maze */
-	list_t *parent; /* Parent node                */
-	list_t *next;   /* Next node in the list      */
-};
-
-/***************************************************************************/
-
-/* Function prototypes */
-maze_t *new_maze();
-void    new_row(cell_t **cells, int lim);
-list_t *new_list();
-list_t *prepend(list_t *list, cell_t *cell);
-void    append(list_t *list, list_t *parent, cell_t *cell);
-maze_t *read_maze(maze_t *maze);
-int     read_row(maze_t *maze, char c, int x, int lim);
-int     read_cell(cell_t *cell, char c, int x, int y, int lim);
-maze_t *print_maze(maze_t *maze);
-void    print_stage_1(cell_t **cell, int x, int y, int xlim, int ylim);
-void    print_stage_2(cell_t **cell, int x, int y, int xlim, int ylim);
-void    print_stage_3(cell_t **cell, int x, int y, int xlim, int ylim);
-void    print_stage_4(cell_t **cell, int x, int y, int xlim, int ylim);
-maze_t *traverse_maze(maze_t *maze);
-list_t *find_entries(cell_t *cell, list_t *queue, int lim);
-cell_t *find_exit(cell_t *cell, cell_t *exit, int cost, int lim);
-void    recursive_flood(maze_t *maze, list_t *queue);
-void    flood_up(maze_t *maze, list_t *queue, int x, int y, int cost);
-void    flood_down(maze_t *maze, list_t *queue, int x, int y, int cost);
-void    flood_left(maze_t *maze, list_t *queue, int x, int y, int cost);
-void    flood_right(maze_t *maze, list_t *queue, int x, int y, int cost);
-void    visit_cell(maze_t *maze, list_t *queue, int x, int y, int cost);
-int     shortest_path(maze_t *maze, list_t *queue, cell_t *exit);
-void    free_list(list_t *list);
-int     free_maze(maze_t *maze);
-void    free_cells(cell_t **cells, int lim);
-
-/***************************************************************************/
-
-/* Handles processing of the maze (Read from right to left) */
-int main(int argc, char **argv) {
-	return free_maze(print_maze(traverse_maze(read_maze(new_maze()))));
-}
-
-/***************************************************************************/
-
-/* Allocates memory for a maze_t struct */
-maze_t *new_maze() {
-	maze_t *maze = (maze_t *)calloc(sizeof(*maze), sizeof(*maze));
-	assert(maze);
-	maze->cells = (cell_t **)malloc(MAX_ROWS * sizeof(*(maze->cells)));
-	assert(maze->cells);
-	new_row(maze->cells, MAX_ROWS);
-	return maze;
-}
-
-/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
-
-/* Recursively allocates 2D array of cells */
-void new_row(cell_t **cells, int lim) {
-	if (lim && cells) {
-		*cells = (cell_t *)calloc(sizeof(**cells), MAX_COLS * sizeof(**cells));
-		assert(*cells);
-		new_row(cells + 1, lim - 1);
-	}
-}
-
-/***************************************************************************/
-
-/* Creates a new list node instance */
-list_t *new_list() {
-	list_t *list = (list_t *)calloc(sizeof(*list), sizeof(*list));
-	assert(list);
-	return list;
-}
-
-/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
-
-/* Append a new node to the end of a list */
-void append(list_t *list, list_t *parent, cell_t *cell) {
-	if (list->next) { 
-		append(list->next, parent, cell);
-	} else {
-		list->next = new_list();
-		list->next->parent = parent;
-		list->next->cell = cell;
-	}
-}
-
-/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
-
-/* Prepends a new node as the head of the list */
-list_t *prepend(list_t *list, cell_t *cell) {
-	list_t *head = new_list();
-	head->cell = cell;
-	head->next = list;
-	return head;
-}
-
-/***************************************************************************/
-
-/* Reads in a maze from a text file */
-maze_t *read_maze(maze_t *maze) {
-	char c;
-	if (scanf(ONECHAR, &c) != EOF && c != NEWLINE) {
-		/* Number of rows read */
-		maze->rows = read_row(maze, c, NIL, MAX_ROWS);
-	}
-	return maze;
-}
-
-/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
-
-/* Recursively reads cell rows */
-int read_row(maze_t *maze, char c, int x, int lim) {
-	if (lim) {
-		/* Number of columns read */
-		maze->cols = read_cell(maze->cells[x], c, x, NIL, MAX_COLS);
-		if (scanf(ONECHAR, &c) != EOF) {
-			return 1 + read_row(maze, c, x + 1, lim - 1);
-		}
-	}
-	return 1;
-}
-
-/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
-
-/* Recursively reads individual cells as columns */
-int read_cell(cell_t *cell, char c, int x, int y, int lim) {
-	if (lim && c != NEWLINE) {
-		cell[y].x = x;
-		cell[y].y = y;
-		cell[y].type = c;
-		cell[y].cost = NOTVISIT;
-		if (scanf(ONECHAR, &c) && c != NEWLINE) {
-			return 1 + read_cell(cell, c, x, y + 1, lim - 1);
-		}
-	}
-	return 1;
-}
-
-/***************************************************************************/
-
-/* Traverses the maze using breadth first search */
-maze_t *traverse_maze(maze_t *maze) {
-	cell_t *ex;
-	list_t *queue = find_entries(*(maze->cells), NULL, maze->cols);
-	recursive_flood(maze, queue);
-	if ((ex = find_exit(maze->cells[LAST_ROW], NULL, NOTVISIT, maze->cols))) {
-		maze->cost = shortest_path(maze, queue, ex);
-		maze->soln = TRUE;
-	}
-	free_list(queue);
-	return maze;
-}
-
-/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
-
-/* Recursively enqueues maze entrances */
-list_t *find_entries(cell_t *cell, list_t *queue, int lim) {
-	if (lim) {
-		if (cell->type == PATH) {
-			cell->reach = TRUE;
-			cell->cost = FALSE;
-			if (!queue) {
-				queue = prepend(queue, cell);
-			} else {
-				append(queue, NULL, cell);
-			}
-		}
-		return find_entries(cell + 1, queue, lim - 1);
-	}
-	return queue;
-}
-
-/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
-
-/* Breadth first search algorithm of 'flooding' the maze with water */
-void recursive_flood(maze_t *maze, list_t *queue) {
-	if (queue) {
-		int x = queue->cell->x, y = queue->cell->y, cost = queue->cell->cost;
-		flood_right(maze, queue, x, y + 1, cost + 1);
-		flood_down(maze, queue, x + 1, y, cost + 1);
-		flood_left(maze, queue, x, y - 1, cost + 1);
-		flood_up(maze, queue, x - 1, y, cost + 1);
-		recursive_flood(maze, queue->next);
-	}
-}
-
-/**-----------------------------------------------------------------------**/
-
-/* Case 1 : Water travels upwards */
-void flood_up(maze_t *maze, list_t *queue, int x, int y, int cost) {
-	if (x >= NIL && maze->cells[x][y].type == PATH) {
-		visit_cell(maze, queue, x, y, cost);
-	}
-}
-
-/**-----------------------------------------------------------------------**/
-
-/* Case 2 : Water travels downwards */
-void flood_down(maze_t *maze, list_t *queue, int x, int y, int cost) {
-	if (x < maze->rows && maze->cells[x][y].type == PATH) {
-		visit_cell(maze, queue, x, y, cost);
-	}
-}
-
-/**-----------------------------------------------------------------------**/
-
-/* Case 3 : Water travels to the left */
-void flood_left(maze_t *maze, list_t *queue, int x, int y, int cost) {
-	if (y >= NIL && maze->cells[x][y].type == PATH) {
-		visit_cell(maze, queue, x, y, cost);
-	}
-}
-
-/**-----------------------------------------------------------------------**/
-
-/* Case 4 : Water travels to the right */
-void flood_right(maze_t *maze, list_t *queue, int x, int y, int cost) {
-	if (y < maze->cols && maze->cells[x][y].type == PATH) {
-		visit_cell(maze, queue, x, y, cost);
-	}
-}
-
-/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
-
-/* Assigns reachability and determines enqueuing of cell */
-void visit_cell(maze_t *maze, list_t *queue, int x, int y, int cost) {
-	maze->cells[x][y].reach = TRUE;
-	if (maze->cells[x][y].cost < NIL || cost < maze->cells[x][y].cost) {
-		maze->cells[x][y].cost = cost;
-		append(queue, queue, &maze->cells[x][y]);
-	}
-}
-
-/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
-
-/* Determines the lowest-costing exit of the maze, if any */
-cell_t *find_exit(cell_t *cell, cell_t *exit, int cost, int lim) {
-	if (lim) {
-		if (cell->type == PATH && cell->reach) {
-			if (cost < NIL || (cell->cost >= NIL && cell->cost < cost)) {
-				return find_exit(cell + 1, cell, cell->cost, lim - 1);
-			}
-		}
-		return find_exit(cell + 1, exit, cost, lim - 1);
-	}
-	return exit;
-}
-
-/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
-
-/* Recursively looks for the shortest exit in the queue and backtracks *
- * through the tree via node parents                                   */
-int shortest_path(maze_t *maze, list_t *queue, cell_t *exit) {
-	if (queue) {
-		if (!exit || queue->cell == exit) {
-			queue->cell->soln = TRUE;
-			return 1 + shortest_path(maze, queue->parent, NULL);
-		}
-		return shortest_path(maze, queue->next, exit);
-	}
-	return - 1;
-}
-
-/***************************************************************************/
-
-/* Handles maze output printing */
-maze_t *print_maze(maze_t *maze) {
-	printf(STAGENUM, STAGE1);
-	printf(PRINT1, maze->rows, maze->cols);
-	print_stage_1(maze->cells, NIL, NIL, maze->rows, maze->cols);
-	printf(ONECHAR, NEWLINE);
-	printf(STAGENUM, STAGE2);
-	if (maze->soln) {
-		printf(PRINT2A);
-		print_stage_2(maze->cells, NIL, NIL, maze->rows, maze->cols);
-		printf(ONECHAR, NEWLINE);
-		printf(STAGENUM, STAGE3);
-		printf(PRINT3A, maze->cost);
-		print_stage_3(maze->cells, NIL, NIL, maze->rows, maze->cols);
-		printf(ONECHAR, NEWLINE);
-		printf(STAGENUM, STAGE4);
-		printf(PRINT4);
-		print_stage_4(maze->cells, NIL, NIL, maze->rows, maze->cols);
-	} else {
-		printf(PRINT2B);
-		print_stage_2(maze->cells, NIL, NIL, maze->rows, maze->cols);
-		printf(ONECHAR, NEWLINE);
-		printf(STAGENUM, STAGE3);
-		printf(PRINT3B);
-		print_stage_3(maze->cells, NIL, NIL, maze->rows, maze->cols);
-	}
-	return maze;
-}
-
-/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
-
-/* Prints output of Stage 1 */
-void print_stage_1(cell_t **cell, int x, int y, int xlim, int ylim) {
-	if (xlim) {
-		if (ylim) {
-			printf(TWOCHAR, (*cell)[y].type, (*cell)[y].type);
-			print_stage_1(cell, x, y + 1, xlim, ylim - 1);
-		} else {
-			printf(ONECHAR, NEWLINE);
-			print_stage_1(cell + 1, x + 1, NIL, xlim - 1, y);
-		}
-	}
-}
-
-/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
-
-/* Prints output of Stage 2 */
-void print_stage_2(cell_t **cell, int x, int y, int xlim, int ylim) {
-	if (xlim) {
-		if (ylim) {
-			if ((*cell)[y].type == PATH) {
-				if ((*cell)[y].reach) {
-					printf(TWOCHAR, REACHABLE, REACHABLE);
-				} else {
-					printf(TWOCHAR, UNREACHABLE, UNREACHABLE);
-				}
-			} else {
-				printf(TWOCHAR, (*cell)[y].type, (*cell)[y].type);
-			}
-			print_stage_2(cell, x, y + 1, xlim, ylim - 1);
-		} else {
-			printf(ONECHAR, NEWLINE);
-			print_stage_2(cell + 1, x + 1, NIL, xlim - 1, y);
-		}
-	}
-}
-
-/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
-
-/* Prints output of Stage 3 */
-void print_stage_3(cell_t **cell, int x, int y, int xlim, int ylim) {
-	if (xlim) {
-		if (ylim) {
-			if ((*cell)[y].type == PATH) {
-				if ((*cell)[y].reach) {
-					if (!((*cell)[y].cost % 2)) {
-						if (((*cell)[y].cost % 100) > 9) {
-							printf(TWODIGIT, (*cell)[y].cost % 100);
-						} else {
-							printf(ONEDIGIT, (*cell)[y].cost % 100);
-						}
-					} else {
-						printf(TWOCHAR, REACHABLE, REACHABLE);
-					}
-				} else {
-					printf(TWOCHAR, UNREACHABLE, UNREACHABLE);
-				}
-			} else {
-				printf(TWOCHAR, (*cell)[y].type, (*cell)[y].type);
-			}
-			print_stage_3(cell, x, y + 1, xlim, ylim - 1);
-		} else {
-			printf(ONECHAR, NEWLINE);
-			print_stage_3(cell + 1, x + 1, NIL, xlim - 1, y);
-		}
-	}
-}
-
-/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
-
-/* Prints output of Stage 4 */
-void print_stage_4(cell_t **cell, int x, int y, int xlim, int ylim) {
-	if (xlim) {
-		if (ylim) {
-			if ((*cell)[y].type == PATH) {
-				if ((*cell)[y].reach) {
-					if ((*cell)[y].soln) {	
-						if (!((*cell)[y].cost % 2)) {
-							if (((*cell)[y].cost % 100) > 9) {
-								printf(TWODIGIT, (*cell)[y].cost % 100);
-							} else {
-								printf(ONEDIGIT, (*cell)[y].cost % 100);
-							}
-						} else {
-							printf(TWOCHAR, PATH, PATH);
-						}
-					} else {
-						printf(TWOCHAR, NONSOLUTION, NONSOLUTION);
-					}
-				} else {
-					printf(TWOCHAR, UNREACHABLE, UNREACHABLE);
-				}
-			} else {
-				printf(TWOCHAR, (*cell)[y].type, (*cell)[y].type);
-			}
-			print_stage_4(cell, x, y + 1, xlim, ylim - 1);
-		} else {
-			printf(ONECHAR, NEWLINE);
-			print_stage_4(cell + 1, x + 1, NIL, xlim - 1, y);
-		}
-	}
-}
-
-/***************************************************************************/
-
-/* Frees memory allocated to a list */
-void free_list(list_t *list) {
-	if (list) {
-		free_list(list->next);
-		free(list);
-	}
-}
-
-/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
-
-/* Frees memory allocated to a maze */
-int free_maze(maze_t *maze) {
-	free_cells(maze->cells, MAX_ROWS);
-	free(maze->cells);
-	free(maze);
-	return EXIT_SUCCESS;
-}
-
-/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
-
-/* Frees memory allocated to a 2D array of cells */
-void free_cells(cell_t **cells, int lim) {
-	if (lim && cells) {
-		free_cells(cells + 1, lim - 1);
-		free(*cells);
-	}
-}
-
-/***************************************************************************/
+/***************************************************************************/
+
+/* Program concept and description :                                       *
+ * Breadth First Search implementation of maze traversing, as a library.   *
+ * Uses a ring buffer of cell indices, preallocated to rows * cols, as the *
+ * queue. Each visited cell records the direction it was entered from, so  *
+ * the cells form a cost-leveled tree with maze entrances as the roots.    *
+ * The exit with the lowest cost is determined after all cells have been   *
+ * traversed and the shortest leftmost path is constructed via following   *
+ * parent directions back to the root. Every pass over the maze is an      *
+ * explicit loop, so stack usage does not grow with the number of cells.   *
+ * The maze is held as separate row-major planes sized from the input: a   *
+ * packed byte of flags and a cost for each cell in the hot planes, and    *
+ * the input characters in a cold plane used only for printing.            *
+ * Coordinates are derived from the index of a cell. Input text is copied  *
+ * into the type plane a row at a time. Each stage is rendered into an     *
+ * output buffer a row at a time and written with one fwrite. Every array  *
+ * a solve needs is cut from an arena of the maze, all of it handed back   *
+ * at once when the next solve starts. The queue engine steps through a    *
+ * copy of the open cells walled on every side, so that no step checks an  *
+ * edge, and common widths have a flood of their own. The bitboard engine  *
+ * instead floods with a bit per cell, 64 cells to a word, and rebuilds    *
+ * parent directions only for the cells that can lie on a shortest path to *
+ * the exit. The hybrid engine floods a level at a time, switching to      *
+ * checking each unvisited cell for a neighbour in the frontier once the   *
+ * frontier is large, and orders each level as the queue would have. The   *
+ * bidirectional engine searches from the entrances and exits at once      *
+ * until the two meet, then floods only the cells that can lie on a path   *
+ * of that cost. The parallel engine splits each large level of one maze   *
+ * between threads, which claim cells by compare and swap on their costs   *
+ * before the level is put back in queue order. The tiled engine keeps     *
+ * costs in 64 by 64 tiles and floods one tile at a time, seeding the      *
+ * tiles beside it with the costs that cross its edges. Mazes may also be  *
+ * given in a binary form, a header and then a bit per cell set for walls  *
+ * in the row layout of the bitboard engine, which is flooded where it     *
+ * lies with no parse. A text maze can instead be swept a row at a time,   *
+ * joining the open cells of each row to those above with union-find       *
+ * labels, so that its Stage 2 verdict needs memory only for a few rows    *
+ * however tall the maze. The same joins over the whole maze, in bands of  *
+ * rows on threads of the parallel engine, label its components when no    *
+ * costs are printed. A solved maze can have cells toggled between wall    *
+ * and path, with only the costs that change, and the path, repaired after *
+ * each. What printing reads of a solved maze packs into a run-length      *
+ * result named by a hash of its input, which restores a repeat of the     *
+ * input without a traversal. The functions of bfs.h wrap all of this for  *
+ * callers that embed the solver.                                          *
+ * Cells are initialised with cost -1 as an indication of not visited      */
+
+/***************************************************************************/
+
+#include "bfs.h"
+#include "maze.h"
+
+/***************************************************************************/
+
+/* Allocates memory for a maze_t struct, its arena, the structures of  *
+ * each engine and its output buffer. Cell planes and engine arrays are *
+ * cut from the arena once the dimensions of the input are known        */
+maze_t *new_maze() {
+	maze_t *maze = (maze_t *)calloc(sizeof(*maze), sizeof(*maze));
+	assert(maze);
+	maze->arena = new_arena();
+	maze->queue = new_queue();
+	maze->bits = new_bits();
+	maze->level = new_level();
+	maze->meet = new_meet();
+	maze->team = new_team();
+	maze->tiles = new_tiles();
+	maze->dial = new_dial();
+	maze->matrix = new_matrix();
+	maze->out = new_out(HEADSIZE);
+	STAT(maze->stats = (stats_t *)calloc(1, sizeof(*(maze->stats))));
+	STAT(assert(maze->stats));
+	return maze;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Prepares the flag, cost and type planes of a maze with every cell *
+ * closed and not visited                                            */
+void new_planes(maze_t *maze) {
+	size_t i, size = (size_t)maze->rows * maze->cols;
+	maze->flag = (uint8_t *)arena_alloc(maze->arena,
+			size * sizeof(*(maze->flag)));
+	maze->costs = (int *)arena_alloc(maze->arena,
+			size * sizeof(*(maze->costs)));
+	maze->type = (char *)arena_alloc(maze->arena,
+			size * sizeof(*(maze->type)));
+	memset(maze->flag, FALSE, size * sizeof(*(maze->flag)));
+	memset(maze->type, FALSE, size * sizeof(*(maze->type)));
+	for (i = NIL; i < size; i++) {
+		maze->costs[i] = NOTVISIT;
+	}
+}
+
+/***************************************************************************/
+
+/* Creates an empty arena, its block allocated once a solve has shown *
+ * how much it needs                                                  */
+arena_t *new_arena() {
+	arena_t *arena = (arena_t *)calloc(1, sizeof(*arena));
+	assert(arena);
+	return arena;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Cuts size bytes, aligned to a cache line, from an arena. What does *
+ * not fit in its block comes from a new block, which later small      *
+ * allocations are cut from in turn                                    */
+void *arena_alloc(arena_t *arena, size_t size) {
+	void *block;
+	size = (size + ALIGN - 1) / ALIGN * ALIGN;
+	arena->used += size;
+	if (arena->top + size <= arena->lim) {
+		block = arena->base + arena->top;
+		arena->top += size;
+		return block;
+	}
+	if (arena->nblocks == arena->blim) {
+		arena->blim = arena->blim ? arena->blim * 2 : 16;
+		arena->blocks = (void **)realloc(arena->blocks,
+				arena->blim * sizeof(*(arena->blocks)));
+		assert(arena->blocks);
+	}
+	block = aligned_alloc(ALIGN, size > SPILL ? size : SPILL);
+	assert(block);
+	arena->blocks[arena->nblocks++] = block;
+	arena->spilled = TRUE;
+	if (size < SPILL) {
+		arena->base = (char *)block;
+		arena->top = size;
+		arena->lim = SPILL;
+	}
+	return block;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Moves the first len bytes of an array to a larger one of size bytes, *
+ * the old one staying in the arena until it is reset                   */
+void *arena_grow(arena_t *arena, void *old, size_t len, size_t size) {
+	void *block = arena_alloc(arena, size);
+	if (len) {
+		memcpy(block, old, len);
+	}
+	return block;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Hands back everything cut from an arena. If the last solve spilled, *
+ * its blocks are replaced by one holding all it asked for             */
+void reset_arena(arena_t *arena) {
+	int i;
+	if (arena->spilled) {
+		for (i = NIL; i < arena->nblocks; i++) {
+			free(arena->blocks[i]);
+		}
+		if (arena->used > arena->lim) {
+			arena->lim = arena->used;
+		}
+		arena->base = (char *)aligned_alloc(ALIGN, arena->lim);
+		assert(arena->base);
+		arena->blocks[NIL] = arena->base;
+		arena->nblocks = 1;
+		arena->spilled = FALSE;
+	}
+	arena->top = arena->used = NIL;
+}
+
+/***************************************************************************/
+
+/* Creates an empty queue, its ring cut from the arena when reset */
+queue_t *new_queue() {
+	queue_t *queue = (queue_t *)calloc(1, sizeof(*queue));
+	assert(queue);
+	return queue;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Empties a queue and makes sure it can hold lim cells, cutting a larger *
+ * ring from the arena if needed                                          */
+void reset_queue(queue_t *queue, arena_t *arena, int lim) {
+	if (lim > queue->lim) {
+		queue->cells = (int *)arena_alloc(arena,
+				lim * sizeof(*(queue->cells)));
+		queue->lim = lim;
+	}
+	queue->head = queue->size = NIL;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Appends a cell to the tail of the queue. Every cell is enqueued at most *
+ * once, so a ring of rows * cols slots never overflows                   */
+void enqueue(queue_t *queue, int cell) {
+	int tail = queue->head + queue->size;
+	assert(queue->size < queue->lim);
+	queue->cells[tail < queue->lim ? tail : tail - queue->lim] = cell;
+	queue->size++;
+	STAT(queue->enqueued++);
+	STAT(queue->peak = queue->size > queue->peak ? queue->size : queue->peak);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Removes and returns the cell at the head of the queue */
+int dequeue(queue_t *queue) {
+	int cell = queue->cells[queue->head];
+	if (++queue->head == queue->lim) {
+		queue->head = NIL;
+	}
+	queue->size--;
+	return cell;
+}
+
+/***************************************************************************/
+
+/* Creates an empty bitboard, its planes cut from the arena when reset */
+bits_t *new_bits() {
+	bits_t *bits = (bits_t *)calloc(1, sizeof(*bits));
+	assert(bits);
+	return bits;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Takes the wall plane of a maze's bitboard from a binary maze, or fills *
+ * it from the flags, clears the rest and makes the entrances the first  *
+ * frontier                                                               */
+bits_t *reset_bits(maze_t *maze) {
+	bits_t *bits = maze->bits;
+	int i, w = maze->cols / WORDBITS + 1;
+	size_t y, size = (size_t)(maze->rows + 2) * w + 2;
+	uint64_t *wall, *planes = (uint64_t *)arena_alloc(maze->arena,
+			size * PLANES * sizeof(*planes));
+	bits->vals = (uint64_t *)arena_alloc(maze->arena,
+			size * sizeof(*(bits->vals)));
+	bits->active = (int *)arena_alloc(maze->arena,
+			size * sizeof(*(bits->active)));
+	bits->cands = (int *)arena_alloc(maze->arena,
+			size * sizeof(*(bits->cands)));
+	bits->stamp = (int *)arena_alloc(maze->arena,
+			size * sizeof(*(bits->stamp)));
+	memset(planes, NIL, size * PLANES * sizeof(*planes));
+	memset(bits->stamp, NIL, size * sizeof(*(bits->stamp)));
+	wall = planes + w + 1;
+	bits->seen = wall + size;
+	bits->front = bits->seen + size;
+	bits->next = bits->front + size;
+	bits->words = w;
+	bits->nactive = NIL;
+	if (maze->wall) {
+		bits->wall = maze->wall;
+	} else {
+		for (y = NIL; y < (size_t)maze->rows * maze->cols; y++) {
+			if (maze->flag[y] & OPEN) {
+				wall[y / maze->cols * w + y % maze->cols / WORDBITS] |=
+					(uint64_t)1 << (y % maze->cols % WORDBITS);
+			}
+		}
+		for (y = NIL; y < (size_t)maze->rows * w; y++) {
+			wall[y] = ~wall[y];
+		}
+		bits->wall = wall;
+	}
+	for (i = NIL; i < w && maze->rows; i++) {
+		if (~bits->wall[i]) {
+			visit_word(maze, bits, i, ~bits->wall[i], NIL);
+		}
+	}
+	return bits;
+}
+
+/***************************************************************************/
+
+/* Creates an empty set of levels, cut from the arena when reset */
+level_t *new_level() {
+	level_t *level = (level_t *)calloc(1, sizeof(*level));
+	assert(level);
+	return level;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Makes the entrances of a maze, from left to right, the first level */
+level_t *reset_level(maze_t *maze) {
+	level_t *level = maze->level;
+	size_t size = (size_t)maze->rows * maze->cols;
+	int y;
+	level->cells = (int *)arena_alloc(maze->arena,
+			size * sizeof(*(level->cells)));
+	level->next = (int *)arena_alloc(maze->arena,
+			size * sizeof(*(level->next)));
+	level->rank = (int *)arena_alloc(maze->arena,
+			size * sizeof(*(level->rank)));
+	level->slots = (int *)arena_alloc(maze->arena,
+			size * 4 * sizeof(*(level->slots)));
+	level->left = (int *)arena_alloc(maze->arena,
+			size * sizeof(*(level->left)));
+	level->size = NIL;
+	level->nleft = NOTVISIT;
+	for (y = NIL; y < maze->cols; y++) {
+		if (maze->flag[y] & OPEN) {
+			maze->flag[y] |= REACH;
+			maze->costs[y] = FALSE;
+			level->cells[level->size++] = y;
+		}
+	}
+	rank_level(level);
+	return level;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Creates an empty exit half of a search, cut from the arena when reset */
+meet_t *new_meet() {
+	meet_t *meet = (meet_t *)calloc(1, sizeof(*meet));
+	assert(meet);
+	return meet;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Makes the exits of a maze, from left to right, the first level of the *
+ * exit half of a search, with every other cell not visited              */
+meet_t *reset_meet(maze_t *maze) {
+	meet_t *meet = maze->meet;
+	size_t i, size = (size_t)maze->rows * maze->cols;
+	int y;
+	meet->costs = (int *)arena_alloc(maze->arena,
+			size * sizeof(*(meet->costs)));
+	meet->cells = (int *)arena_alloc(maze->arena,
+			size * sizeof(*(meet->cells)));
+	meet->next = (int *)arena_alloc(maze->arena,
+			size * sizeof(*(meet->next)));
+	for (i = NIL; i < size; i++) {
+		meet->costs[i] = NOTVISIT;
+	}
+	meet->size = meet->depth = NIL;
+	for (y = INDEX(maze, LAST_ROW, NIL); y < (int)size; y++) {
+		if (maze->flag[y] & OPEN) {
+			meet->costs[y] = NIL;
+			meet->cells[meet->size++] = y;
+		}
+	}
+	return meet;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Creates a team with no threads, which are added when a maze is flooded */
+team_t *new_team() {
+	team_t *team = (team_t *)calloc(1, sizeof(*team));
+	assert(team);
+	return team;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Adds a cell to those a thread claimed this level, growing its array */
+void claim_cell(member_t *member, int cell) {
+	if (member->size == member->lim) {
+		member->lim = member->lim ? member->lim * 2 : GRAIN;
+		member->cells = (int *)realloc(member->cells,
+				member->lim * sizeof(*(member->cells)));
+		assert(member->cells);
+	}
+	member->cells[member->size++] = cell;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Creates an empty set of tiles, cut from the arena when reset */
+tiles_t *new_tiles() {
+	tiles_t *tiles = (tiles_t *)calloc(1, sizeof(*tiles));
+	assert(tiles);
+	return tiles;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Copies the open cells of a maze into tiles, with every cell not   *
+ * visited, and seeds the top row of tiles with the entrances. Cells *
+ * of edge tiles beyond the maze are closed. The planes are first    *
+ * written here, so on hosts with memory local to each processor the *
+ * pages of a tile sit by the thread that set the maze up            */
+tiles_t *reset_tiles(maze_t *maze) {
+	tiles_t *tiles = maze->tiles;
+	int i, x, y, down = (maze->rows + TILE - 1) >> TILESHIFT;
+	size_t size;
+	tiles->arena = maze->arena;
+	tiles->across = (maze->cols + TILE - 1) >> TILESHIFT;
+	tiles->ntiles = tiles->across * down;
+	size = (size_t)tiles->ntiles * TILECELLS;
+	tiles->open = (uint8_t *)arena_alloc(maze->arena,
+			size * sizeof(*(tiles->open)));
+	tiles->costs = (int *)arena_alloc(maze->arena,
+			size * sizeof(*(tiles->costs)));
+	tiles->tiles = (tile_t *)arena_alloc(maze->arena,
+			tiles->ntiles * sizeof(*(tiles->tiles)));
+	tiles->cells = (int *)arena_alloc(maze->arena,
+			TILECELLS * sizeof(*(tiles->cells)));
+	memset(tiles->open, FALSE, size * sizeof(*(tiles->open)));
+	memset(tiles->tiles, NIL, tiles->ntiles * sizeof(*(tiles->tiles)));
+	for (i = NIL; i < (int)size; i++) {
+		tiles->costs[i] = NOTVISIT;
+	}
+	for (x = i = NIL; x < maze->rows; x++) {
+		for (y = NIL; y < maze->cols; y++, i++) {
+			tiles->open[tile_cell(tiles, x, y)] = maze->flag[i] & OPEN;
+		}
+	}
+	tiles->heap = NULL;
+	tiles->nheap = tiles->hlim = NIL;
+	for (y = NIL; y < maze->cols; y++) {
+		if (maze->flag[y] & OPEN) {
+			seed_cell(tiles, y >> TILESHIFT, y & (TILE - 1), NIL);
+		}
+	}
+	return tiles;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Creates an empty bucket queue, its links cut from the arena when reset */
+dial_t *new_dial() {
+	dial_t *dial = (dial_t *)calloc(1, sizeof(*dial));
+	assert(dial);
+	return dial;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Cuts nbuckets empty buckets and links for every cell of a maze, the *
+ * buckets stacked or not                                              */
+dial_t *reset_dial(maze_t *maze, int nbuckets, int stacked) {
+	dial_t *dial = maze->dial;
+	size_t size = (size_t)maze->rows * maze->cols;
+	int i;
+	dial->next = (int *)arena_alloc(maze->arena,
+			size * sizeof(*(dial->next)));
+	dial->prev = (int *)arena_alloc(maze->arena,
+			size * sizeof(*(dial->prev)));
+	dial->head = (int *)arena_alloc(maze->arena,
+			nbuckets * sizeof(*(dial->head)));
+	dial->tail = (int *)arena_alloc(maze->arena,
+			nbuckets * sizeof(*(dial->tail)));
+	dial->nbuckets = nbuckets;
+	dial->stacked = stacked;
+	for (i = NIL; i < nbuckets; i++) {
+		dial->head[i] = dial->tail[i] = NOTVISIT;
+	}
+	dial->size = NIL;
+	return dial;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Creates an empty matrix, its arrays cut from the arena when reset */
+matrix_t *new_matrix() {
+	matrix_t *matrix = (matrix_t *)calloc(1, sizeof(*matrix));
+	assert(matrix);
+	return matrix;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Lists the entrances and exits of a maze and cuts a matrix of their  *
+ * costs, none yet found, and the planes of its floods from the arena  */
+matrix_t *reset_matrix(maze_t *maze) {
+	matrix_t *matrix = maze->matrix;
+	size_t i, size = (size_t)maze->rows * maze->cols;
+	int y, last = INDEX(maze, LAST_ROW, NIL);
+	matrix->entries = (int *)arena_alloc(maze->arena,
+			maze->cols * sizeof(*(matrix->entries)));
+	matrix->exits = (int *)arena_alloc(maze->arena,
+			maze->cols * sizeof(*(matrix->exits)));
+	matrix->slot = (int *)arena_alloc(maze->arena,
+			maze->cols * sizeof(*(matrix->slot)));
+	matrix->nentries = matrix->nexits = NIL;
+	for (y = NIL; y < maze->cols; y++) {
+		if (maze->flag[y] & OPEN) {
+			matrix->entries[matrix->nentries++] = y;
+		}
+		matrix->slot[y] = NOTVISIT;
+		if (maze->flag[last + y] & OPEN) {
+			matrix->slot[y] = matrix->nexits;
+			matrix->exits[matrix->nexits++] = y;
+		}
+	}
+	size = (size_t)matrix->nentries * matrix->nexits;
+	matrix->costs = (int *)arena_alloc(maze->arena,
+			size * sizeof(*(matrix->costs)));
+	for (i = NIL; i < size; i++) {
+		matrix->costs[i] = NOTVISIT;
+	}
+	matrix->nbuckets = maze->weighted ? BUCKETS : 2;
+	matrix->stride = matrix->nbuckets + 1;
+	matrix->words = (uint64_t *)arena_alloc(maze->arena, (size_t)maze->rows *
+			maze->cols * matrix->stride * sizeof(*(matrix->words)));
+	for (y = NIL; y < matrix->nbuckets; y++) {
+		matrix->cells[y] = NULL;
+		matrix->size[y] = matrix->lim[y] = NIL;
+	}
+	matrix->waiting = NIL;
+	return matrix;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Index in the tile planes of the cell at row x, column y */
+int tile_cell(tiles_t *tiles, int x, int y) {
+	return ((x >> TILESHIFT) * tiles->across + (y >> TILESHIFT)) * TILECELLS
+		+ ((x & (TILE - 1)) << TILESHIFT) + (y & (TILE - 1));
+}
+
+/***************************************************************************/
+
+/* Builds the maze from its text. The width of the first line sets the *
+ * number of columns; longer lines are truncated to it. Binary text is *
+ * expected to have been checked by binary_len. A caching maze hashes  *
+ * the text first                                                      */
+maze_t *parse_text(maze_t *maze, char *text, size_t len) {
+	char *eol;
+	maze->rows = maze->cols = maze->cost = NIL;
+	maze->soln = maze->partial = FALSE;
+	maze->wall = NULL;
+	maze->solved = FALSE;
+	maze->exit = NOTVISIT;
+	maze->dirty = NULL;
+	maze->labels = NULL;
+	maze->labelled = FALSE;
+	maze->tabled = FALSE;
+	maze->hash = maze->caching ? hash_text(text, len) : NIL;
+	reset_arena(maze->arena);
+	maze->queue->lim = NIL;
+	STAT(memset(maze->stats, NIL, sizeof(*(maze->stats))));
+	STAT(maze->queue->enqueued = maze->queue->peak = NIL);
+	if (is_binary(text, len)) {
+		read_binary(maze, text);
+	} else if (len && *text != NEWLINE) {
+		eol = (char *)memchr(text, NEWLINE, len);
+		maze->cols = eol ? (int)(eol - text) : (int)len;
+		maze->rows = count_rows(text, len);
+		new_planes(maze);
+		read_rows(maze, text, len);
+	}
+	maze->kernel = pick_kernel(maze->cols);
+	return maze;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Counts the lines of text, including a final unterminated line */
+int count_rows(char *text, size_t len) {
+	int rows = NIL;
+	char *end = text + len, *eol = text;
+	while ((eol = (char *)memchr(eol, NEWLINE, end - eol))) {
+		eol++;
+		rows++;
+	}
+	return rows + (text[len - 1] != NEWLINE);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Copies each line of text into a row of the type plane, then flags the *
+ * open cells in one pass over the whole plane                           */
+void read_rows(maze_t *maze, char *text, size_t len) {
+	int x;
+	size_t i, width, size = (size_t)maze->rows * maze->cols;
+	char *end = text + len, *eol;
+	for (x = NIL; x < maze->rows; x++) {
+		if (!(eol = (char *)memchr(text, NEWLINE, end - text))) {
+			eol = end;
+		}
+		width = eol - text;
+		if (width > (size_t)maze->cols) {
+			width = maze->cols;
+		}
+		memcpy(maze->type + INDEX(maze, (size_t)x, NIL), text, width);
+		text = eol + (eol < end);
+	}
+	for (i = NIL; i < size; i++) {
+		maze->flag[i] = maze->type[i] == PATH || (maze->weighted &&
+				maze->type[i] >= '0' && maze->type[i] <= '0' + MAXWEIGHT) ?
+			OPEN : FALSE;
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Checks whether text starts with the magic of a binary maze */
+int is_binary(char *text, size_t len) {
+	return len >= MAGICLEN && !memcmp(text, MAGIC, MAGICLEN);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Returns the length of the binary maze text starts with, or zero if it *
+ * is malformed, has a row with a padding bit clear or runs past the end *
+ * of the text. A row is the fewest words that hold its cells, or one    *
+ * more, and each count is checked against the bytes left before it is   *
+ * multiplied, so no size can wrap                                       */
+size_t binary_len(char *text, size_t len) {
+	head_t head;
+	size_t x, size, words, left;
+	uint64_t pad;
+	const uint64_t *row = (const uint64_t *)(text + sizeof(head));
+	if (len < sizeof(head) || !is_binary(text, len)) {
+		return NIL;
+	}
+	memcpy(&head, text, sizeof(head));
+	left = len - sizeof(head);
+	if ((!head.rows) != (!head.cols) ||
+			(uint64_t)head.rows * head.cols > INT32_MAX ||
+			head.stride < (head.cols + WORDBITS - 1) / WORDBITS ||
+			head.stride > head.cols / WORDBITS + 1 ||
+			(head.rows &&
+				head.rows > left / sizeof(uint64_t) / head.stride) ||
+			head.nentries > head.cols || head.nexits > head.cols) {
+		return NIL;
+	}
+	words = (size_t)head.rows * head.stride;
+	left -= words * sizeof(uint64_t);
+	if ((size_t)head.nentries + head.nexits > left / sizeof(uint32_t)) {
+		return NIL;
+	}
+	size = sizeof(head) + words * sizeof(uint64_t) +
+		((size_t)head.nentries + head.nexits) * sizeof(uint32_t);
+	size = (size + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+	if (size > len) {
+		return NIL;
+	}
+	if (head.stride > head.cols / WORDBITS) {
+		pad = ~(((uint64_t)1 << (head.cols % WORDBITS)) - 1);
+		for (x = NIL; x < words; x += head.stride) {
+			if ((row[x + head.cols / WORDBITS] & pad) != pad) {
+				return NIL;
+			}
+		}
+	}
+	return size;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Builds the maze from the wall plane of a binary maze. A plane in the *
+ * row layout of the bitboard engine is left for it to flood in place   */
+void read_binary(maze_t *maze, char *text) {
+	head_t head;
+	int x, y;
+	size_t i;
+	const uint64_t *row;
+	memcpy(&head, text, sizeof(head));
+	if (!head.rows) {
+		return;
+	}
+	maze->rows = head.rows;
+	maze->cols = head.cols;
+	new_planes(maze);
+	row = (const uint64_t *)(text + sizeof(head));
+	if (head.stride == (uint32_t)maze->cols / WORDBITS + 1) {
+		maze->wall = row;
+	}
+	for (x = NIL, i = NIL; x < maze->rows; x++, row += head.stride) {
+		for (y = NIL; y < maze->cols; y++, i++) {
+			if (row[y / WORDBITS] >> (y % WORDBITS) & 1) {
+				maze->type[i] = WALL;
+				maze->flag[i] = FALSE;
+			} else {
+				maze->type[i] = PATH;
+				maze->flag[i] = OPEN;
+			}
+		}
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Writes the maze in binary form, its wall plane a row at a time. Every *
+ * cell that is not a path becomes a wall                                */
+void write_binary(maze_t *maze, FILE *fp) {
+	head_t head;
+	int x, y, w = maze->cols ? maze->cols / WORDBITS + 1 : NIL;
+	size_t size;
+	uint64_t *row = (uint64_t *)arena_alloc(maze->arena,
+			(w + 1) * sizeof(*row));
+	uint32_t *ends = (uint32_t *)arena_alloc(maze->arena,
+			((size_t)maze->cols * 2 + 2) * sizeof(*ends));
+	memset(&head, NIL, sizeof(head));
+	memcpy(head.magic, MAGIC, MAGICLEN);
+	head.rows = maze->rows;
+	head.cols = maze->cols;
+	head.stride = w;
+	for (y = NIL; y < maze->cols; y++) {
+		if (maze->flag[y] & OPEN) {
+			ends[head.nentries++] = y;
+		}
+	}
+	for (y = NIL; y < maze->cols; y++) {
+		if (maze->flag[INDEX(maze, LAST_ROW, y)] & OPEN) {
+			ends[head.nentries + head.nexits++] = y;
+		}
+	}
+	fwrite(&head, sizeof(head), 1, fp);
+	for (x = NIL; x < maze->rows; x++) {
+		memset(row, 0xff, w * sizeof(*row));
+		for (y = NIL; y < maze->cols; y++) {
+			if (maze->flag[INDEX(maze, x, y)] & OPEN) {
+				row[y / WORDBITS] &= ~((uint64_t)1 << (y % WORDBITS));
+			}
+		}
+		fwrite(row, sizeof(*row), w, fp);
+	}
+	size = (head.nentries + head.nexits) * sizeof(*ends);
+	memset((char *)ends + size, NIL, sizeof(uint64_t) - 1);
+	fwrite(ends, 1, (size + sizeof(uint64_t) - 1) / sizeof(uint64_t) *
+			sizeof(uint64_t), fp);
+}
+
+/***************************************************************************/
+
+/* Traverses the maze using breadth first search with the chosen engine. *
+ * Engines that record no parent directions have the ones the path needs *
+ * rebuilt once the exit is known. Early termination uses no engine, and *
+ * weighted mazes are flooded from a bucket queue whatever the engine.   *
+ * Unless Stage 2 is printed, the bidirectional and informed engines     *
+ * search for the lowest cost and then flood only the cells a path of    *
+ * that cost could cross; the informed engines skip even that flood      *
+ * unless Stage 4 is printed. Otherwise they flood as the queue does.    *
+ * With neither Stage 3 nor Stage 4 printed no costs are needed, and the *
+ * cells reached are those of the components labelled with an entrance.  *
+ * Stage 5 has the costs between entrances and exits found first         */
+maze_t *traverse_maze(maze_t *maze) {
+	int ex;
+	maze->solved = TRUE;
+	maze->labelled = FALSE;
+	if (maze->early) {
+		maze->soln = flood_verdict(maze);
+		return maze;
+	}
+	if (maze->stages & 1 << STAGE5) {
+		matrix_maze(maze);
+	}
+	if (!(maze->stages & (1 << STAGE3 | 1 << STAGE4))) {
+		label_maze(maze);
+		maze->soln = reach_labels(maze);
+		maze->labelled = TRUE;
+		return maze;
+	}
+	if (maze->weighted) {
+		flood_dial(maze);
+	} else if ((maze->engine == BIDIR || maze->engine == ASTAR ||
+			maze->engine == JPS) && !(maze->stages & 1 << STAGE2)) {
+		maze->partial = TRUE;
+		ex = maze->engine == BIDIR ? meet_maze(maze) :
+			maze->engine == ASTAR ? star_maze(maze) : jump_maze(maze);
+		if (ex != NOTVISIT && maze->engine != BIDIR &&
+				!(maze->stages & 1 << STAGE4)) {
+			maze->cost = ex;
+			maze->soln = TRUE;
+			return maze;
+		}
+		if (ex != NOTVISIT) {
+			flood_pruned(maze, ex);
+		}
+	} else switch (maze->engine) {
+		case BITBOARD:
+			flood_bits(maze);
+			break;
+		case HYBRID:
+			flood_hybrid(maze);
+			break;
+		case PARALLEL:
+			flood_parallel(maze);
+			break;
+		case TILED:
+			flood_tiles(maze);
+			break;
+		default:
+			maze->kernel(maze);
+	}
+	if ((ex = find_exit(maze)) != NOTVISIT) {
+		if (!maze->weighted && (maze->engine == BITBOARD ||
+				maze->engine == TILED)) {
+			trace_path(maze, ex);
+		}
+		maze->cost = shortest_path(maze, ex);
+		maze->soln = TRUE;
+		maze->exit = ex;
+	}
+	return maze;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Returns the flood of the queue engine for a maze cols wide */
+kernel_t pick_kernel(int cols) {
+	switch (cols) {
+		case 64:
+			return flood_64;
+		case 128:
+			return flood_128;
+		case 256:
+			return flood_256;
+		case 1024:
+			return flood_1024;
+		default:
+			return flood_any;
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Breadth first search algorithm of 'flooding' the maze with water, for *
+ * a maze cols wide. Entrances are queued from left to right, then the   *
+ * loop takes cells from the head of the queue while newly visited cells *
+ * are appended at its tail. Each queued cell keeps its index in the     *
+ * padded plane beside it, a step moving both by the same neighbour. As  *
+ * every cell is queued once, the ring is only ever filled from its head */
+KERNEL void flood_maze(maze_t *maze, int cols) {
+	int stride = PADDED(cols), head, tail = NIL, cell, spot, cost, y;
+	int *cells, *spots, *costs = maze->costs;
+	uint8_t *flag = maze->flag, *open = pad_maze(maze, cols);
+	reset_queue(maze->queue, maze->arena, maze->rows * cols);
+	cells = maze->queue->cells;
+	spots = (int *)arena_alloc(maze->arena,
+			(size_t)maze->rows * cols * sizeof(*spots));
+	for (y = NIL; y < cols; y++) {
+		if (flag[y] & OPEN) {
+			flag[y] |= REACH;
+			costs[y] = FALSE;
+			cells[tail] = y;
+			spots[tail++] = stride + y;
+		}
+	}
+	for (head = NIL; head < tail; head++) {
+		cell = cells[head];
+		spot = spots[head];
+		cost = costs[cell] + 1;
+		STAT(maze->stats->visits += open[spot + 1] + open[spot + stride] +
+				open[spot - 1] + open[spot - stride]);
+		if (open[spot + 1] && costs[cell + 1] < NIL) {
+			flag[cell + 1] = (flag[cell + 1] & ~PARENT) | REACH |
+				RIGHT << PSHIFT;
+			costs[cell + 1] = cost;
+			cells[tail] = cell + 1;
+			spots[tail++] = spot + 1;
+		}
+		if (open[spot + stride] && costs[cell + cols] < NIL) {
+			flag[cell + cols] = (flag[cell + cols] & ~PARENT) | REACH |
+				DOWN << PSHIFT;
+			costs[cell + cols] = cost;
+			cells[tail] = cell + cols;
+			spots[tail++] = spot + stride;
+		}
+		if (open[spot - 1] && costs[cell - 1] < NIL) {
+			flag[cell - 1] = (flag[cell - 1] & ~PARENT) | REACH |
+				LEFT << PSHIFT;
+			costs[cell - 1] = cost;
+			cells[tail] = cell - 1;
+			spots[tail++] = spot - 1;
+		}
+		if (open[spot - stride] && costs[cell - cols] < NIL) {
+			flag[cell - cols] = (flag[cell - cols] & ~PARENT) | REACH |
+				UP << PSHIFT;
+			costs[cell - cols] = cost;
+			cells[tail] = cell - cols;
+			spots[tail++] = spot - stride;
+		}
+		STAT(maze->queue->peak = tail - head - 1 > maze->queue->peak ?
+				tail - head - 1 : maze->queue->peak);
+	}
+	STAT(maze->queue->enqueued += tail);
+}
+
+/**-----------------------------------------------------------------------**/
+
+/* Case 1 : A maze 64 columns wide */
+void flood_64(maze_t *maze) {
+	flood_maze(maze, 64);
+}
+
+/**-----------------------------------------------------------------------**/
+
+/* Case 2 : A maze 128 columns wide */
+void flood_128(maze_t *maze) {
+	flood_maze(maze, 128);
+}
+
+/**-----------------------------------------------------------------------**/
+
+/* Case 3 : A maze 256 columns wide */
+void flood_256(maze_t *maze) {
+	flood_maze(maze, 256);
+}
+
+/**-----------------------------------------------------------------------**/
+
+/* Case 4 : A maze 1024 columns wide */
+void flood_1024(maze_t *maze) {
+	flood_maze(maze, 1024);
+}
+
+/**-----------------------------------------------------------------------**/
+
+/* Case 5 : A maze of any other width */
+void flood_any(maze_t *maze) {
+	flood_maze(maze, maze->cols);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Cuts the padded plane of a maze cols wide from the arena, a byte set *
+ * for each open cell and clear for the walls around them. Cell x, y is *
+ * byte (x + 1) * PADDED(cols) + y, so the column of walls after a row  *
+ * is also the one before the next                                      */
+uint8_t *pad_maze(maze_t *maze, int cols) {
+	int x, y, stride = PADDED(cols);
+	size_t size = ((size_t)maze->rows + 2) * stride;
+	uint8_t *open = (uint8_t *)arena_alloc(maze->arena, size), *row;
+	const uint8_t *flag = maze->flag;
+	memset(open, FALSE, stride);
+	for (x = NIL, row = open + stride; x < maze->rows; x++) {
+		for (y = NIL; y < cols; y++) {
+			row[y] = flag[y] & OPEN;
+		}
+		row[cols] = FALSE;
+		row += stride;
+		flag += cols;
+	}
+	memset(row, FALSE, stride);
+	return open;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Determines the lowest-costing exit of the maze, if any. Ties go to *
+ * the leftmost exit                                                  */
+int find_exit(maze_t *maze) {
+	int y, exit = NOTVISIT, cost = NOTVISIT, *costs;
+	uint8_t *flag = maze->flag + INDEX(maze, LAST_ROW, NIL);
+	costs = maze->costs + INDEX(maze, LAST_ROW, NIL);
+	for (y = NIL; y < maze->cols; y++) {
+		if ((flag[y] & OPEN) && (flag[y] & REACH)) {
+			if (cost < NIL || (costs[y] >= NIL && costs[y] < cost)) {
+				exit = INDEX(maze, LAST_ROW, y);
+				cost = costs[y];
+			}
+		}
+	}
+	return exit;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Backtracks from the exit through the tree via parent directions until *
+ * an entrance is reached, returning the cost of the path. Entrances are *
+ * the only cells of the first row the path can reach, as every one is   */
+int shortest_path(maze_t *maze, int exit) {
+	int cell = exit;
+	maze->flag[cell] |= SOLN;
+	while (cell >= maze->cols) {
+		cell = parent_cell(maze, cell);
+		maze->flag[cell] |= SOLN;
+	}
+	return maze->costs[exit];
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Steps back against the direction a visited cell was entered from */
+int parent_cell(maze_t *maze, int cell) {
+	switch ((maze->flag[cell] & PARENT) >> PSHIFT) {
+		case RIGHT:
+			return cell - 1;
+		case DOWN:
+			return cell - maze->cols;
+		case LEFT:
+			return cell + 1;
+		default:
+			return cell + maze->cols;
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Steps from a cell in direction dir, returning NOTVISIT at the edge of *
+ * the maze                                                             */
+int next_cell(maze_t *maze, int cell, int dir) {
+	int y = cell % maze->cols;
+	switch (dir) {
+		case RIGHT:
+			return y < LAST_COL ? cell + 1 : NOTVISIT;
+		case DOWN:
+			return cell < INDEX(maze, LAST_ROW, NIL) ? cell + maze->cols
+				: NOTVISIT;
+		case LEFT:
+			return y > NIL ? cell - 1 : NOTVISIT;
+		default:
+			return cell >= maze->cols ? cell - maze->cols : NOTVISIT;
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Rebuilds parent directions from costs alone for the cells able to lie *
+ * on a shortest path to exit. Walking back from the exit to neighbours  *
+ * one cost lower marks those cells, and with them every cell any of     *
+ * them could have been entered from, so a breadth first search kept to  *
+ * the marked cells enters each one in the same order, and from the same *
+ * direction, as the queue engine would                                  */
+void trace_path(maze_t *maze, int exit) {
+	queue_t *queue = maze->queue;
+	int y, dir, cell, next;
+	reset_queue(queue, maze->arena, maze->rows * maze->cols);
+	maze->flag[exit] |= MARK;
+	enqueue(queue, exit);
+	while (queue->size) {
+		cell = dequeue(queue);
+		for (dir = RIGHT; dir <= UP && maze->costs[cell]; dir++) {
+			next = next_cell(maze, cell, dir);
+			if (next != NOTVISIT && !(maze->flag[next] & MARK) &&
+					(maze->flag[next] & REACH) &&
+					maze->costs[next] == maze->costs[cell] - 1) {
+				maze->flag[next] |= MARK;
+				enqueue(queue, next);
+			}
+		}
+	}
+	for (y = NIL; y < maze->cols; y++) {
+		if (maze->flag[y] & MARK) {
+			maze->flag[y] &= ~MARK;
+			enqueue(queue, y);
+		}
+	}
+	while (queue->size) {
+		cell = dequeue(queue);
+		for (dir = RIGHT; dir <= UP; dir++) {
+			next = next_cell(maze, cell, dir);
+			if (next != NOTVISIT && (maze->flag[next] & MARK) &&
+					maze->costs[next] == maze->costs[cell] + 1) {
+				maze->flag[next] = (maze->flag[next] & ~(MARK | PARENT)) |
+					dir << PSHIFT;
+				enqueue(queue, next);
+			}
+		}
+	}
+}
+
+/***************************************************************************/
+
+/* Hybrid engine. Floods the maze a level at a time, expanding small    *
+ * frontiers top-down from each frontier cell and, while the frontier   *
+ * makes up a large part of what is left, bottom-up from each unvisited *
+ * cell. Both keep every level in queue order, so parent directions and *
+ * the path match the queue engine                                       */
+void flood_hybrid(maze_t *maze) {
+	level_t *level = reset_level(maze);
+	size_t i, open = NIL, left;
+	int cost, last = NIL, up = FALSE;
+	for (i = NIL; i < (size_t)maze->rows * maze->cols; i++) {
+		open += maze->flag[i] & OPEN;
+	}
+	left = open - level->size;
+	for (cost = 1; level->size; cost++) {
+		if (!up && level->size >= last &&
+				(size_t)level->size * ALPHA > left) {
+			up = TRUE;
+		} else if (up && level->size < last &&
+				(size_t)level->size * BETA < open) {
+			up = FALSE;
+		}
+		last = level->size;
+		if (up) {
+			step_up(maze, level, cost);
+		} else {
+			step_down(maze, level, cost);
+		}
+		left -= level->size;
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Expands a level top-down, each frontier cell in turn visiting its    *
+ * unvisited neighbours in the order water travels, as the queue would */
+void step_down(maze_t *maze, level_t *level, int cost) {
+	int i, dir, cell, size = NIL, *swap;
+	for (i = NIL; i < level->size; i++) {
+		for (dir = RIGHT; dir <= UP; dir++) {
+			cell = next_cell(maze, level->cells[i], dir);
+			if (cell != NOTVISIT && (maze->flag[cell] & OPEN) &&
+					maze->costs[cell] < NIL) {
+				maze->flag[cell] = (maze->flag[cell] & ~PARENT) | REACH |
+					dir << PSHIFT;
+				maze->costs[cell] = cost;
+				level->next[size++] = cell;
+			}
+		}
+	}
+	swap = level->cells;
+	level->cells = level->next;
+	level->next = swap;
+	level->size = size;
+	rank_level(level);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Expands a level bottom-up, each unvisited cell taking as its parent  *
+ * the frontier neighbour of lowest rank, which is the one the queue    *
+ * would have reached it from. A cell is then slotted by its parent's   *
+ * rank and the direction it was entered from, so reading the slots in *
+ * order gives the next level in queue order                            */
+void step_up(maze_t *maze, level_t *level, int cost) {
+	int i, dir, cell, next, best, key = NIL, size = NIL, nleft = NIL;
+	int *swap;
+	if (level->nleft == NOTVISIT) {
+		list_left(maze, level);
+	}
+	memset(level->slots, 0xff, (size_t)level->size * 4 *
+			sizeof(*(level->slots)));
+	for (i = NIL; i < level->nleft; i++) {
+		if (maze->costs[cell = level->left[i]] >= NIL) {
+			continue;
+		}
+		for (best = NOTVISIT, dir = RIGHT; dir <= UP; dir++) {
+			next = next_cell(maze, cell, dir);
+			if (next != NOTVISIT && maze->costs[next] == cost - 1 &&
+					(best == NOTVISIT ||
+					level->rank[next] < level->rank[best])) {
+				best = next;
+				key = level->rank[next] * 4 + OPPOSITE(dir);
+			}
+		}
+		if (best == NOTVISIT) {
+			level->left[nleft++] = cell;
+			continue;
+		}
+		maze->flag[cell] = (maze->flag[cell] & ~PARENT) | REACH |
+			key % 4 << PSHIFT;
+		maze->costs[cell] = cost;
+		level->slots[key] = cell;
+	}
+	level->nleft = nleft;
+	for (i = NIL; i < level->size * 4; i++) {
+		if (level->slots[i] != NOTVISIT) {
+			level->next[size++] = level->slots[i];
+		}
+	}
+	swap = level->cells;
+	level->cells = level->next;
+	level->next = swap;
+	level->size = size;
+	rank_level(level);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Lists the open cells not yet visited, for the first bottom-up level. *
+ * Later bottom-up levels drop the cells visited since                  */
+void list_left(maze_t *maze, level_t *level) {
+	size_t i;
+	level->nleft = NIL;
+	for (i = NIL; i < (size_t)maze->rows * maze->cols; i++) {
+		if ((maze->flag[i] & OPEN) && maze->costs[i] < NIL) {
+			level->left[level->nleft++] = (int)i;
+		}
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Records the position of each cell in the frontier of a level */
+void rank_level(level_t *level) {
+	int i;
+	for (i = NIL; i < level->size; i++) {
+		level->rank[level->cells[i]] = i;
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Floods the maze from the entrances only until water reaches the last *
+ * row, marking cells reachable but keeping no costs or directions.     *
+ * Returns whether the maze has a solution                              */
+int flood_verdict(maze_t *maze) {
+	queue_t *queue = maze->queue;
+	int y, dir, cell, next, last = INDEX(maze, LAST_ROW, NIL);
+	reset_queue(queue, maze->arena, maze->rows * maze->cols);
+	for (y = NIL; y < maze->cols; y++) {
+		if (maze->flag[y] & OPEN) {
+			maze->flag[y] |= REACH;
+			if (y >= last) {
+				return TRUE;
+			}
+			enqueue(queue, y);
+		}
+	}
+	while (queue->size) {
+		cell = dequeue(queue);
+		for (dir = RIGHT; dir <= UP; dir++) {
+			next = next_cell(maze, cell, dir);
+			if (next != NOTVISIT && (maze->flag[next] & OPEN) &&
+					!(maze->flag[next] & REACH)) {
+				maze->flag[next] |= REACH;
+				if (next >= last) {
+					return TRUE;
+				}
+				enqueue(queue, next);
+			}
+		}
+	}
+	return FALSE;
+}
+
+/***************************************************************************/
+
+/* Labels each open cell with the component it lies in: the first cell of *
+ * the component in row order, so that a component holds an entrance      *
+ * exactly when its label lies in the first row. Cells are joined to the  *
+ * open cells left of and above them in a union-find forest whose roots   *
+ * are the least cells of their trees, a band of rows to each thread of   *
+ * the parallel engine. The bands are then joined at their edges and one  *
+ * pass in row order takes each cell to its root, whose label it has by   *
+ * then as no cell's parent follows it. Walls are labelled NOTVISIT       */
+void label_maze(maze_t *maze) {
+	int i, cell, nbands = maze->engine == PARALLEL ? maze->threads : 1;
+	int size = maze->rows * maze->cols;
+	band_t *bands;
+	maze->labels = (int *)arena_alloc(maze->arena,
+			(size_t)size * sizeof(*(maze->labels)));
+	for (; nbands > 1 && (nbands > maze->rows || size / nbands < GRAIN);
+			nbands--);
+	bands = (band_t *)arena_alloc(maze->arena, nbands * sizeof(*bands));
+	for (i = NIL; i < nbands; i++) {
+		bands[i].maze = maze;
+		bands[i].first = (int)((long)maze->rows * i / nbands);
+		bands[i].last = (int)((long)maze->rows * (i + 1) / nbands);
+	}
+	for (i = 1; i < nbands; i++) {
+		if (pthread_create(&bands[i].thread, NULL, label_band, bands + i)) {
+			perror("pthread_create");
+			exit(EXIT_FAILURE);
+		}
+	}
+	label_band(bands);
+	for (i = 1; i < nbands; i++) {
+		pthread_join(bands[i].thread, NULL);
+		for (cell = INDEX(maze, bands[i].first, NIL);
+				cell < INDEX(maze, bands[i].first + 1, NIL); cell++) {
+			if ((maze->flag[cell] & OPEN) &&
+					(maze->flag[cell - maze->cols] & OPEN)) {
+				join_cells(maze->labels, cell, cell - maze->cols);
+			}
+		}
+	}
+	for (cell = maze->ncomps = NIL; cell < size; cell++) {
+		if (maze->labels[cell] != NOTVISIT) {
+			maze->labels[cell] = maze->labels[maze->labels[cell]];
+			maze->ncomps += maze->labels[cell] == cell;
+		}
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Body of a labelling thread, joining the open cells of its band to *
+ * their neighbours within it                                        */
+void *label_band(void *arg) {
+	band_t *band = (band_t *)arg;
+	maze_t *maze = band->maze;
+	int x, y, cell = INDEX(maze, band->first, NIL);
+	for (x = band->first; x < band->last; x++) {
+		for (y = NIL; y < maze->cols; y++, cell++) {
+			if (!(maze->flag[cell] & OPEN)) {
+				maze->labels[cell] = NOTVISIT;
+				continue;
+			}
+			maze->labels[cell] = cell;
+			if (y && (maze->flag[cell - 1] & OPEN)) {
+				join_cells(maze->labels, cell, cell - 1);
+			}
+			if (x > band->first && (maze->flag[cell - maze->cols] & OPEN)) {
+				join_cells(maze->labels, cell, cell - maze->cols);
+			}
+		}
+	}
+	return NULL;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Joins the components of two cells, the greater root taking the lesser */
+void join_cells(int *labels, int a, int b) {
+	a = find_cell(labels, a);
+	b = find_cell(labels, b);
+	if (a < b) {
+		labels[b] = a;
+	} else if (b < a) {
+		labels[a] = b;
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Finds the root of a cell's component, halving the path to it */
+int find_cell(int *labels, int cell) {
+	while (labels[cell] != cell) {
+		cell = labels[cell] = labels[labels[cell]];
+	}
+	return cell;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Marks the cells of components holding an entrance as reachable, from *
+ * their labels alone. Returns whether any exit is reachable            */
+int reach_labels(maze_t *maze) {
+	int cell, soln = FALSE, size = maze->rows * maze->cols;
+	for (cell = NIL; cell < size; cell++) {
+		if (maze->labels[cell] != NOTVISIT && maze->labels[cell] < maze->cols) {
+			maze->flag[cell] |= REACH;
+			soln |= cell >= size - maze->cols;
+		}
+	}
+	return soln;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Floods a maze traversed with no parents again with the queue engine *
+ * and every stage, so that its cells can be toggled                   */
+void reflood_maze(maze_t *maze) {
+	int engine = maze->engine, stages = maze->stages;
+	clear_maze(maze);
+	maze->engine = QUEUE;
+	maze->stages = STAGES;
+	traverse_maze(maze);
+	maze->engine = engine;
+	maze->stages = stages;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Drops the costs, reached cells and solution of a traversed maze, *
+ * leaving its open cells to be traversed again                     */
+void clear_maze(maze_t *maze) {
+	size_t i, size = (size_t)maze->rows * maze->cols;
+	for (i = NIL; i < size; i++) {
+		maze->flag[i] &= OPEN;
+		maze->costs[i] = NOTVISIT;
+	}
+	maze->cost = NIL;
+	maze->soln = maze->partial = maze->solved = FALSE;
+	maze->exit = NOTVISIT;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Whether a maze is traversed far enough to print the stages given.    *
+ * Stage 2 needs every cell flooded, Stage 3 the cost, which labels     *
+ * alone leave out, and Stage 4 the exit too, which astar and jps leave *
+ * out without it                                                       */
+int covers_stages(const maze_t *maze, int stages) {
+	if (!maze->solved || (stages & 1 << STAGE2 && maze->partial)) {
+		return FALSE;
+	}
+	if (stages & (1 << STAGE3 | 1 << STAGE4) && maze->labelled) {
+		return FALSE;
+	}
+	return !(stages & 1 << STAGE4 && maze->soln && maze->exit == NOTVISIT);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Traverses a maze not yet traversed far enough to print the stages  *
+ * given, again for both those and its own stages if it was traversed. *
+ * A maze with no cells yet is left alone                              */
+void cover_stages(maze_t *maze, int stages) {
+	int saved = maze->stages;
+	if (maze->flag && !covers_stages(maze, stages)) {
+		if (maze->solved) {
+			clear_maze(maze);
+		}
+		maze->stages |= stages;
+		traverse_maze(maze);
+		maze->stages = saved;
+	}
+}
+
+/***************************************************************************/
+
+/* Parallel engine. Floods the maze a level at a time as the hybrid      *
+ * engine does top-down, sharing each level with GRAIN or more cells per *
+ * thread out between the threads of the maze's team. Smaller levels are *
+ * expanded by the calling thread while the others wait                  */
+void flood_parallel(maze_t *maze) {
+	team_t *team = maze->team;
+	int i, threads = maze->threads > 1 ? maze->threads : 1;
+	reset_level(maze);
+	if (threads > team->lim) {
+		team->members = (member_t *)realloc(team->members,
+				threads * sizeof(*(team->members)));
+		team->counts = (int *)realloc(team->counts,
+				threads * sizeof(*(team->counts)));
+		assert(team->members && team->counts);
+		memset(team->members + team->lim, NIL,
+				(threads - team->lim) * sizeof(*(team->members)));
+		team->lim = threads;
+	}
+	team->maze = maze;
+	team->threads = threads;
+	team->cost = team->done = NIL;
+	pthread_barrier_init(&team->barrier, NULL, threads);
+	for (i = NIL; i < threads; i++) {
+		team->members[i].team = team;
+		team->members[i].id = i;
+		if (i && pthread_create(&team->members[i].thread, NULL, run_member,
+				team->members + i)) {
+			perror("pthread_create");
+			exit(EXIT_FAILURE);
+		}
+	}
+	run_member(team->members);
+	for (i = 1; i < threads; i++) {
+		pthread_join(team->members[i].thread, NULL);
+	}
+	pthread_barrier_destroy(&team->barrier);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Body of each thread of a team. The first thread expands small levels *
+ * alone and decides when the flood is done; then all threads expand    *
+ * the next level together                                              */
+void *run_member(void *arg) {
+	member_t *member = (member_t *)arg;
+	team_t *team = member->team;
+	level_t *level = team->maze->level;
+	while (TRUE) {
+		if (!member->id) {
+			while (level->size && level->size < GRAIN * team->threads) {
+				step_down(team->maze, level, ++team->cost);
+			}
+			team->done = !level->size;
+		}
+		pthread_barrier_wait(&team->barrier);
+		if (team->done) {
+			break;
+		}
+		step_team(member);
+	}
+	return NULL;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Expands a level with every thread of a team, each taking an even run *
+ * of the frontier. Threads claim unvisited neighbours by compare and   *
+ * swap on their costs, so each cell is claimed once and at its cost,   *
+ * but by whichever thread got there first. Each claimed cell then      *
+ * takes as its parent the frontier neighbour of lowest rank and is     *
+ * slotted by that rank and its direction, as in a bottom-up level, and *
+ * the threads gather their runs of the slots into the next level       */
+void step_team(member_t *member) {
+	team_t *team = member->team;
+	maze_t *maze = team->maze;
+	level_t *level = maze->level;
+	int i, dir, cell, next, best, key = NIL, unset, start = NIL, *swap;
+	int cost = team->cost + 1, threads = team->threads;
+	int lo = (int)((long)level->size * member->id / threads);
+	int hi = (int)((long)level->size * (member->id + 1) / threads);
+	memset(level->slots + (size_t)lo * 4, 0xff, (size_t)(hi - lo) * 4 *
+			sizeof(*(level->slots)));
+	member->size = NIL;
+	for (i = lo; i < hi; i++) {
+		for (dir = RIGHT; dir <= UP; dir++) {
+			cell = next_cell(maze, level->cells[i], dir);
+			unset = NOTVISIT;
+			if (cell != NOTVISIT && (maze->flag[cell] & OPEN) &&
+					__atomic_load_n(maze->costs + cell, __ATOMIC_RELAXED) < NIL
+					&& __atomic_compare_exchange_n(maze->costs + cell, &unset,
+					cost, FALSE, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				claim_cell(member, cell);
+			}
+		}
+	}
+	pthread_barrier_wait(&team->barrier);
+	for (i = NIL; i < member->size; i++) {
+		cell = member->cells[i];
+		for (best = NOTVISIT, dir = RIGHT; dir <= UP; dir++) {
+			next = next_cell(maze, cell, dir);
+			if (next != NOTVISIT && maze->costs[next] == cost - 1 &&
+					(best == NOTVISIT ||
+					level->rank[next] < level->rank[best])) {
+				best = next;
+				key = level->rank[next] * 4 + OPPOSITE(dir);
+			}
+		}
+		maze->flag[cell] = (maze->flag[cell] & ~PARENT) | REACH |
+			key % 4 << PSHIFT;
+		level->slots[key] = cell;
+	}
+	pthread_barrier_wait(&team->barrier);
+	for (team->counts[member->id] = NIL, i = lo * 4; i < hi * 4; i++) {
+		team->counts[member->id] += level->slots[i] != NOTVISIT;
+	}
+	pthread_barrier_wait(&team->barrier);
+	for (i = NIL; i < member->id; i++) {
+		start += team->counts[i];
+	}
+	for (i = lo * 4; i < hi * 4; i++) {
+		if (level->slots[i] != NOTVISIT) {
+			level->next[start] = level->slots[i];
+			level->rank[level->slots[i]] = start++;
+		}
+	}
+	pthread_barrier_wait(&team->barrier);
+	if (!member->id) {
+		swap = level->cells;
+		level->cells = level->next;
+		level->next = swap;
+		for (level->size = i = NIL; i < threads; i++) {
+			level->size += team->counts[i];
+		}
+		team->cost = cost;
+	}
+}
+
+/***************************************************************************/
+
+/* Tiled engine. Floods the waiting tiles one at a time, each from its   *
+ * seeds and the lowest seed cost first, until no tile has seeds left,   *
+ * then copies the costs back to the maze. A tile's flood stays within   *
+ * the tile, whose cells are contiguous, and only reaches other tiles    *
+ * through the seeds it leaves them, as costs lower than they hold.      *
+ * Costs only ever fall, so the tiles settle on the costs a full flood   *
+ * gives, and taking the cheapest tile first keeps tiles from being      *
+ * flooded again to lower costs still                                    */
+void flood_tiles(maze_t *maze) {
+	tiles_t *tiles = reset_tiles(maze);
+	int i, x, y, cost;
+	while ((i = pop_tile(tiles)) != NOTVISIT) {
+		flood_tile(tiles, i);
+	}
+	for (x = i = NIL; x < maze->rows; x++) {
+		for (y = NIL; y < maze->cols; y++, i++) {
+			if ((cost = tiles->costs[tile_cell(tiles, x, y)]) >= NIL) {
+				maze->flag[i] |= REACH;
+				maze->costs[i] = cost;
+			}
+		}
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Floods a tile from its seeds. The seeds are sorted by cost and merged *
+ * into the queue as the flood reaches their cost, so cells leave the    *
+ * queue in order of cost and each one is queued at most once            */
+void flood_tile(tiles_t *tiles, int tile) {
+	tile_t *t = tiles->tiles + tile;
+	int *costs = tiles->costs + (size_t)tile * TILECELLS;
+	uint8_t *open = tiles->open + (size_t)tile * TILECELLS;
+	int i = NIL, head = NIL, tail = NIL, dir, cell, cost, next, to;
+	t->queued = FALSE;
+	qsort(t->seeds, t->nseeds, 2 * sizeof(*(t->seeds)), cmp_seeds);
+	while (i < t->nseeds || head < tail) {
+		if (head < tail && (i == t->nseeds ||
+				costs[tiles->cells[head]] <= t->seeds[2 * i + 1])) {
+			cell = tiles->cells[head++];
+		} else if (costs[cell = t->seeds[2 * i]] < t->seeds[2 * i + 1]) {
+			i++;
+			continue;
+		} else {
+			i++;
+		}
+		cost = costs[cell] + 1;
+		for (dir = RIGHT; dir <= UP; dir++) {
+			to = tile;
+			if ((next = tile_step(tiles, &to, cell, dir)) == NOTVISIT) {
+				continue;
+			}
+			if (to != tile) {
+				seed_cell(tiles, to, next, cost);
+			} else if (open[next] && (costs[next] < NIL ||
+					cost < costs[next])) {
+				costs[next] = cost;
+				tiles->cells[tail++] = next;
+			}
+		}
+	}
+	t->nseeds = NIL;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Steps from a cell of a tile in direction dir, moving to the tile      *
+ * beside it at an edge. Returns the cell within its tile, or NOTVISIT   *
+ * at the edge of the maze                                               */
+int tile_step(tiles_t *tiles, int *tile, int cell, int dir) {
+	int x = cell >> TILESHIFT, y = cell & (TILE - 1);
+	switch (dir) {
+		case RIGHT:
+			if (y < TILE - 1) {
+				return cell + 1;
+			}
+			if ((*tile + 1) % tiles->across == NIL) {
+				return NOTVISIT;
+			}
+			*tile += 1;
+			return cell - (TILE - 1);
+		case DOWN:
+			if (x < TILE - 1) {
+				return cell + TILE;
+			}
+			if (*tile + tiles->across >= tiles->ntiles) {
+				return NOTVISIT;
+			}
+			*tile += tiles->across;
+			return y;
+		case LEFT:
+			if (y > NIL) {
+				return cell - 1;
+			}
+			if (*tile % tiles->across == NIL) {
+				return NOTVISIT;
+			}
+			*tile -= 1;
+			return cell + (TILE - 1);
+		default:
+			if (x > NIL) {
+				return cell - TILE;
+			}
+			if (*tile < tiles->across) {
+				return NOTVISIT;
+			}
+			*tile -= tiles->across;
+			return cell + TILECELLS - TILE;
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Lowers the cost of an open cell of a tile from beside it, keeping it *
+ * as a seed and queueing the tile to be flooded                        */
+void seed_cell(tiles_t *tiles, int tile, int cell, int cost) {
+	tile_t *t = tiles->tiles + tile;
+	int *costs = tiles->costs + (size_t)tile * TILECELLS;
+	if (!tiles->open[(size_t)tile * TILECELLS + cell] ||
+			(costs[cell] >= NIL && costs[cell] <= cost)) {
+		return;
+	}
+	costs[cell] = cost;
+	if (t->nseeds == t->lim) {
+		t->seeds = (int *)arena_grow(tiles->arena, t->seeds,
+				2 * t->lim * sizeof(*(t->seeds)),
+				2 * (t->lim ? t->lim * 2 : TILE) * sizeof(*(t->seeds)));
+		t->lim = t->lim ? t->lim * 2 : TILE;
+	}
+	t->seeds[2 * t->nseeds] = cell;
+	t->seeds[2 * t->nseeds++ + 1] = cost;
+	if (!t->queued || cost < t->least) {
+		t->queued = TRUE;
+		push_tile(tiles, tile, t->least = cost);
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Orders seeds by cost */
+int cmp_seeds(const void *a, const void *b) {
+	return ((const int *)a)[1] - ((const int *)b)[1];
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Pushes a tile onto the heap of those waiting, keyed by cost */
+void push_tile(tiles_t *tiles, int tile, int cost) {
+	int i = tiles->nheap++, up, *heap;
+	if (tiles->nheap > tiles->hlim) {
+		tiles->heap = (int *)arena_grow(tiles->arena, tiles->heap,
+				2 * tiles->hlim * sizeof(*(tiles->heap)),
+				2 * (tiles->hlim ? tiles->hlim * 2 : TILE) *
+				sizeof(*(tiles->heap)));
+		tiles->hlim = tiles->hlim ? tiles->hlim * 2 : TILE;
+	}
+	for (heap = tiles->heap; i && heap[2 * (up = (i - 1) / 2)] > cost;
+			i = up) {
+		heap[2 * i] = heap[2 * up];
+		heap[2 * i + 1] = heap[2 * up + 1];
+	}
+	heap[2 * i] = cost;
+	heap[2 * i + 1] = tile;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Pops the waiting tile with the lowest seed cost, skipping pairs left *
+ * behind, or returns NOTVISIT once none are waiting                    */
+int pop_tile(tiles_t *tiles) {
+	int i, down, cost, tile, last, *heap = tiles->heap;
+	while (tiles->nheap) {
+		cost = heap[0];
+		tile = heap[1];
+		last = --tiles->nheap;
+		for (i = NIL; (down = 2 * i + 1) < last; i = down) {
+			if (down + 1 < last && heap[2 * down + 2] < heap[2 * down]) {
+				down++;
+			}
+			if (heap[2 * down] >= heap[2 * last]) {
+				break;
+			}
+			heap[2 * i] = heap[2 * down];
+			heap[2 * i + 1] = heap[2 * down + 1];
+		}
+		heap[2 * i] = heap[2 * last];
+		heap[2 * i + 1] = heap[2 * last + 1];
+		if (tiles->tiles[tile].queued && tiles->tiles[tile].least == cost) {
+			return tile;
+		}
+	}
+	return NOTVISIT;
+}
+
+/***************************************************************************/
+
+/* Bidirectional engine. Expands whichever half of the search, from the *
+ * entrances or from the exits, has the smaller frontier by a level at  *
+ * a time until a level joins the two, returning the lowest cost of a   *
+ * path through the cells they share, or NOTVISIT if either half runs   *
+ * dry first. Only costs from the entrances are kept on the maze        */
+int meet_maze(maze_t *maze) {
+	level_t *level = reset_level(maze);
+	meet_t *meet = reset_meet(maze);
+	int i, cost = NOTVISIT;
+	for (i = NIL; i < level->size; i++) {
+		if (meet->costs[level->cells[i]] == NIL) {
+			cost = NIL;
+		}
+	}
+	while (cost == NOTVISIT && level->size && meet->size) {
+		if (level->size <= meet->size) {
+			cost = meet_entries(maze, level, meet);
+		} else {
+			cost = meet_exits(maze, meet);
+		}
+	}
+	return cost;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Expands the entrance half by a level, returning the lowest cost of a *
+ * path through a cell the exit half has visited, or NOTVISIT if none   */
+int meet_entries(maze_t *maze, level_t *level, meet_t *meet) {
+	int i, dir, cell, cost, size = NIL, best = NOTVISIT, *swap;
+	for (i = NIL; i < level->size; i++) {
+		cost = maze->costs[level->cells[i]] + 1;
+		for (dir = RIGHT; dir <= UP; dir++) {
+			cell = next_cell(maze, level->cells[i], dir);
+			if (cell != NOTVISIT && (maze->flag[cell] & OPEN) &&
+					maze->costs[cell] < NIL) {
+				maze->flag[cell] |= REACH;
+				maze->costs[cell] = cost;
+				level->next[size++] = cell;
+				if (meet->costs[cell] >= NIL && (best == NOTVISIT ||
+						cost + meet->costs[cell] < best)) {
+					best = cost + meet->costs[cell];
+				}
+			}
+		}
+	}
+	swap = level->cells;
+	level->cells = level->next;
+	level->next = swap;
+	level->size = size;
+	return best;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Expands the exit half by a level, returning the lowest cost of a path *
+ * through a cell the entrance half has visited, or NOTVISIT if none     */
+int meet_exits(maze_t *maze, meet_t *meet) {
+	int i, dir, cell, cost = ++meet->depth, size = NIL, best = NOTVISIT;
+	int *swap;
+	for (i = NIL; i < meet->size; i++) {
+		for (dir = RIGHT; dir <= UP; dir++) {
+			cell = next_cell(maze, meet->cells[i], dir);
+			if (cell != NOTVISIT && (maze->flag[cell] & OPEN) &&
+					meet->costs[cell] < NIL) {
+				meet->costs[cell] = cost;
+				meet->next[size++] = cell;
+				if (maze->costs[cell] >= NIL && (best == NOTVISIT ||
+						cost + maze->costs[cell] < best)) {
+					best = cost + maze->costs[cell];
+				}
+			}
+		}
+	}
+	swap = meet->cells;
+	meet->cells = meet->next;
+	meet->next = swap;
+	meet->size = size;
+	return best;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Floods the maze from the entrances as the queue engine would, except  *
+ * that a cell is left unvisited when its cost plus the least it could   *
+ * still cost to reach an exit is more than the cost of the best path.   *
+ * That bound is admissible and changes by at most one between           *
+ * neighbours. So every cell a kept cell could have been entered from is *
+ * kept too, and the kept cells are entered in the same order and from   *
+ * the same directions as in a full flood, giving the same leftmost path */
+void flood_pruned(maze_t *maze, int cost) {
+	queue_t *queue = maze->queue;
+	int i, y, dir, cell, next, here;
+	reset_queue(queue, maze->arena, maze->rows * maze->cols);
+	for (y = NIL; y < maze->cols; y++) {
+		if ((maze->flag[y] & OPEN) && least_left(maze, y) <= cost) {
+			maze->flag[y] |= MARK;
+			enqueue(queue, y);
+		}
+	}
+	while (queue->size) {
+		cell = dequeue(queue);
+		here = maze->costs[cell] + 1;
+		for (dir = RIGHT; dir <= UP; dir++) {
+			next = next_cell(maze, cell, dir);
+			if (next != NOTVISIT && (maze->flag[next] & OPEN) &&
+					!(maze->flag[next] & MARK) &&
+					here + least_left(maze, next) <= cost) {
+				maze->flag[next] = (maze->flag[next] & ~PARENT) | MARK |
+					REACH | dir << PSHIFT;
+				maze->costs[next] = here;
+				enqueue(queue, next);
+			}
+		}
+	}
+	for (i = NIL; i < queue->head; i++) {
+		maze->flag[queue->cells[i]] &= ~MARK;
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Least cost a cell could still need to reach an exit. For the          *
+ * bidirectional engine it is the cost from the exit half of the search, *
+ * or one more than its last level for cells it never reached; for the   *
+ * informed engines it is the rows left below the cell                   */
+int least_left(maze_t *maze, int cell) {
+	meet_t *meet = maze->meet;
+	if (maze->engine != BIDIR) {
+		return LAST_ROW - cell / maze->cols;
+	}
+	return meet->costs[cell] >= NIL ? meet->costs[cell] : meet->depth + 1;
+}
+
+/***************************************************************************/
+
+/* A* engine. Takes cells from the entrances in order of their cost plus *
+ * the rows left below them, a bound that never overstates the cost to   *
+ * an exit and changes by at most one a step, so the first exit taken is *
+ * one of lowest cost and no cell taken is given a lower cost later.     *
+ * Keys grow by at most two a step, so a few buckets hold them all, and  *
+ * are stacked so that ties go deepest first.                            *
+ * Returns the lowest cost, or NOTVISIT if no exit is reached            */
+int star_maze(maze_t *maze) {
+	dial_t *dial = reset_dial(maze, BUCKETS, TRUE);
+	int y, dir, cell, next, cost, key = LAST_ROW;
+	for (y = NIL; y < maze->cols; y++) {
+		if (maze->flag[y] & OPEN) {
+			maze->flag[y] |= REACH;
+			maze->costs[y] = NIL;
+			link_cell(maze, dial, y, LAST_ROW);
+		}
+	}
+	while ((cell = pop_dial(maze, dial, &key)) != NOTVISIT) {
+		if (cell >= INDEX(maze, LAST_ROW, NIL)) {
+			drain_dial(maze, dial);
+			return maze->costs[cell];
+		}
+		cost = maze->costs[cell] + 1;
+		for (dir = RIGHT; dir <= UP; dir++) {
+			next = next_cell(maze, cell, dir);
+			if (next != NOTVISIT && (maze->flag[next] & OPEN) &&
+					(maze->costs[next] < NIL || cost < maze->costs[next])) {
+				if (maze->flag[next] & QUEUED) {
+					unlink_cell(maze, dial, next,
+							maze->costs[next] + least_left(maze, next));
+				}
+				maze->costs[next] = cost;
+				link_cell(maze, dial, next, cost + least_left(maze, next));
+			}
+		}
+	}
+	return NOTVISIT;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Jump point search. A* over only the cells a shortest path may need to *
+ * turn at, found by jumping along rows and columns from each. A path    *
+ * turns off a column wherever it likes, and off a row only past a wall  *
+ * beside it, so columns are searched first. Jump points go on in every  *
+ * direction but back. Keys grow by less than the columns and twice the  *
+ * rows a jump. Returns the lowest cost, or NOTVISIT if no exit is       *
+ * reached                                                               */
+int jump_maze(maze_t *maze) {
+	dial_t *dial = reset_dial(maze, maze->cols + 2 * maze->rows, TRUE);
+	uint8_t *lands = reset_lands(maze);
+	int y, dir, cell, next, cost, from, key = LAST_ROW;
+	for (y = NIL; y < maze->cols; y++) {
+		if (maze->flag[y] & OPEN) {
+			maze->flag[y] |= REACH;
+			maze->costs[y] = NIL;
+			link_cell(maze, dial, y, LAST_ROW);
+		}
+	}
+	while ((cell = pop_dial(maze, dial, &key)) != NOTVISIT) {
+		if (cell >= INDEX(maze, LAST_ROW, NIL)) {
+			drain_dial(maze, dial);
+			return maze->costs[cell];
+		}
+		from = (maze->flag[cell] & PARENT) >> PSHIFT;
+		for (dir = RIGHT; dir <= UP; dir++) {
+			if ((cell >= maze->cols && dir == OPPOSITE(from)) ||
+					(next = jump_cell(maze, lands, cell, dir)) == NOTVISIT) {
+				continue;
+			}
+			cost = maze->costs[cell] + (dir == RIGHT || dir == LEFT ?
+				abs(next - cell) : abs(next - cell) / maze->cols);
+			if (maze->costs[next] < NIL || cost < maze->costs[next]) {
+				if (maze->flag[next] & QUEUED) {
+					unlink_cell(maze, dial, next,
+							maze->costs[next] + least_left(maze, next));
+				}
+				maze->costs[next] = cost;
+				maze->flag[next] = (maze->flag[next] & ~PARENT) |
+					dir << PSHIFT;
+				link_cell(maze, dial, next, cost + least_left(maze, next));
+			}
+		}
+	}
+	return NOTVISIT;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Jumps from a cell in direction dir to the next cell a shortest path   *
+ * may turn at, or NOTVISIT if a wall or the edge comes first. Along a   *
+ * row that is an exit or a cell a path may turn at; along a column it   *
+ * is an exit or a cell from which a jump along its row lands, as marked *
+ * in lands                                                              */
+int jump_cell(maze_t *maze, uint8_t *lands, int cell, int dir) {
+	int x = cell / maze->cols, y = cell % maze->cols;
+	int dx = dir == DOWN ? 1 : dir == UP ? - 1 : NIL;
+	int dy = dir == RIGHT ? 1 : dir == LEFT ? - 1 : NIL;
+	for (x += dx, y += dy; x >= NIL && x < maze->rows && y >= NIL &&
+			y < maze->cols; x += dx, y += dy) {
+		if (!(maze->flag[cell = INDEX(maze, x, y)] & OPEN)) {
+			return NOTVISIT;
+		}
+		if (x == LAST_ROW || (dx ? lands[cell] :
+				turns_at(maze, cell, cell - dy))) {
+			return cell;
+		}
+	}
+	return NOTVISIT;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Checks whether a path along a row from cell to next may turn at next: *
+ * whether next has an open neighbour above or below where cell has a    *
+ * wall                                                                  */
+int turns_at(maze_t *maze, int next, int cell) {
+	int cols = maze->cols;
+	return (next >= cols && (maze->flag[next - cols] & OPEN) &&
+			!(maze->flag[cell - cols] & OPEN)) ||
+		(next < INDEX(maze, LAST_ROW, NIL) &&
+			(maze->flag[next + cols] & OPEN) &&
+			!(maze->flag[cell + cols] & OPEN));
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Marks the cells from which a jump along the row lands, sweeping each *
+ * row once each way: a cell is marked if the cell beside it is open    *
+ * and is an exit, a cell a path may turn at or marked on that side     */
+uint8_t *reset_lands(maze_t *maze) {
+	int x, y, c;
+	uint8_t seen, *lands = (uint8_t *)arena_alloc(maze->arena,
+			(size_t)maze->rows * maze->cols * sizeof(*lands));
+	for (x = NIL; x < maze->rows; x++) {
+		for (seen = FALSE, y = LAST_COL; y >= NIL; y--) {
+			c = INDEX(maze, x, y);
+			seen = y < LAST_COL && (maze->flag[c + 1] & OPEN) &&
+				(seen || x == LAST_ROW || turns_at(maze, c + 1, c));
+			lands[c] = seen;
+		}
+		for (seen = FALSE, y = NIL; y < maze->cols; y++) {
+			c = INDEX(maze, x, y);
+			seen = y > NIL && (maze->flag[c - 1] & OPEN) &&
+				(seen || x == LAST_ROW || turns_at(maze, c - 1, c));
+			lands[c] |= seen;
+		}
+	}
+	return lands;
+}
+
+/***************************************************************************/
+
+/* Bitboard engine. Floods the maze a level at a time, expanding the     *
+ * frontier a word of 64 cells at a time as                              *
+ * next = (f << 1 | f >> 1 | up | down) & open & ~seen. While the        *
+ * frontier is sparse only the words around it are expanded; once it is  *
+ * dense every word is swept, with vector instructions where available.  *
+ * Reachability and costs are set from the new cells of each level       */
+void flood_bits(maze_t *maze) {
+	bits_t *bits = reset_bits(maze);
+	long words = (long)maze->rows * bits->words;
+	int cost;
+	for (cost = 1; bits->nactive; cost++) {
+		if ((long)bits->nactive * DENSE > words) {
+			step_dense(maze, bits, cost);
+		} else {
+			step_sparse(maze, bits, cost);
+		}
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Expands a sparse frontier into the words it touches, then replaces it *
+ * with the words that gained cells                                      */
+void step_sparse(maze_t *maze, bits_t *bits, int cost) {
+	int i, word, ncands = NIL, w = bits->words, words = maze->rows * w;
+	for (i = NIL; i < bits->nactive; i++) {
+		word = bits->active[i];
+		touch_word(bits, word, &ncands, cost);
+		if (word % w) {
+			touch_word(bits, word - 1, &ncands, cost);
+		}
+		if ((word + 1) % w) {
+			touch_word(bits, word + 1, &ncands, cost);
+		}
+		if (word >= w) {
+			touch_word(bits, word - w, &ncands, cost);
+		}
+		if (word + w < words) {
+			touch_word(bits, word + w, &ncands, cost);
+		}
+	}
+	for (i = NIL; i < ncands; i++) {
+		word = bits->cands[i];
+		bits->vals[i] = expand_word(bits, word) &
+			~(bits->wall[word] | bits->seen[word]);
+	}
+	for (i = NIL; i < bits->nactive; i++) {
+		bits->front[bits->active[i]] = NIL;
+	}
+	bits->nactive = NIL;
+	for (i = NIL; i < ncands; i++) {
+		if (bits->vals[i]) {
+			visit_word(maze, bits, bits->cands[i], bits->vals[i], cost);
+		}
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Expands a dense frontier by sweeping every word of the maze into the *
+ * next plane, which then becomes the frontier. The guard words let the *
+ * sweep read past either end of a row and the maze without checks      */
+void step_dense(maze_t *maze, bits_t *bits, int cost) {
+	int word = NIL, w = bits->words, words = maze->rows * w;
+	uint64_t *f = bits->front, *next = bits->next;
+#if defined(__AVX512F__)
+	for (; word + 8 <= words; word += 8) {
+		__m512i c = _mm512_loadu_si512(f + word);
+		__m512i h = _mm512_or_si512(
+			_mm512_or_si512(_mm512_slli_epi64(c, 1),
+				_mm512_srli_epi64(_mm512_loadu_si512(f + word - 1), 63)),
+			_mm512_or_si512(_mm512_srli_epi64(c, 1),
+				_mm512_slli_epi64(_mm512_loadu_si512(f + word + 1), 63)));
+		__m512i v = _mm512_or_si512(_mm512_loadu_si512(f + word - w),
+			_mm512_loadu_si512(f + word + w));
+		_mm512_storeu_si512(next + word, _mm512_andnot_si512(
+			_mm512_or_si512(_mm512_loadu_si512(bits->seen + word),
+				_mm512_loadu_si512(bits->wall + word)),
+			_mm512_or_si512(h, v)));
+	}
+#elif defined(__AVX2__)
+	for (; word + 4 <= words; word += 4) {
+		__m256i c = _mm256_loadu_si256((__m256i *)(f + word));
+		__m256i h = _mm256_or_si256(
+			_mm256_or_si256(_mm256_slli_epi64(c, 1), _mm256_srli_epi64(
+				_mm256_loadu_si256((__m256i *)(f + word - 1)), 63)),
+			_mm256_or_si256(_mm256_srli_epi64(c, 1), _mm256_slli_epi64(
+				_mm256_loadu_si256((__m256i *)(f + word + 1)), 63)));
+		__m256i v = _mm256_or_si256(
+			_mm256_loadu_si256((__m256i *)(f + word - w)),
+			_mm256_loadu_si256((__m256i *)(f + word + w)));
+		_mm256_storeu_si256((__m256i *)(next + word), _mm256_andnot_si256(
+			_mm256_or_si256(
+				_mm256_loadu_si256((__m256i *)(bits->seen + word)),
+				_mm256_loadu_si256((__m256i *)(bits->wall + word))),
+			_mm256_or_si256(h, v)));
+	}
+#endif
+	for (; word < words; word++) {
+		next[word] = expand_word(bits, word) &
+			~(bits->wall[word] | bits->seen[word]);
+	}
+	bits->front = next;
+	bits->next = f;
+	bits->nactive = NIL;
+	for (word = NIL; word < words; word++) {
+		if (next[word]) {
+			visit_word(maze, bits, word, next[word], cost);
+		}
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Gathers the cells next to the frontier cells of a word: its own cells *
+ * shifted either way with the bits carried in from the words beside it, *
+ * and the words above and below                                          */
+uint64_t expand_word(bits_t *bits, int word) {
+	uint64_t *f = bits->front;
+	return f[word] << 1 | f[word - 1] >> (WORDBITS - 1) | f[word] >> 1 |
+		f[word + 1] << (WORDBITS - 1) | f[word - bits->words] |
+		f[word + bits->words];
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Adds a word to the candidates of a sparse level, once per level */
+void touch_word(bits_t *bits, int word, int *ncands, int cost) {
+	if (bits->stamp[word] != cost) {
+		bits->stamp[word] = cost;
+		bits->cands[(*ncands)++] = word;
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Makes the new cells of a word part of the frontier, assigning them *
+ * reachability and cost                                              */
+void visit_word(maze_t *maze, bits_t *bits, int word, uint64_t cells,
+		int cost) {
+	int cell = INDEX(maze, word / bits->words,
+			word % bits->words * WORDBITS);
+	bits->front[word] = cells;
+	bits->seen[word] |= cells;
+	bits->active[bits->nactive++] = word;
+	for (; cells; cells &= cells - 1) {
+		maze->flag[cell + __builtin_ctzll(cells)] |= REACH;
+		maze->costs[cell + __builtin_ctzll(cells)] = cost;
+	}
+}
+
+/***************************************************************************/
+
+/* Dial's algorithm: costs grow a bucket at a time, and the cells of the  *
+ * bucket of the current cost are taken from its head while neighbours    *
+ * given lower costs join the buckets of their own. Cells costing naught  *
+ * to enter join the bucket being emptied. With every weight one it takes *
+ * cells in the order the queue would, so finds the same parents          */
+void flood_dial(maze_t *maze) {
+	dial_t *dial = reset_dial(maze, BUCKETS, FALSE);
+	int y, cell, next, dir, cost = NIL;
+	for (y = NIL; y < maze->cols; y++) {
+		if (maze->flag[y] & OPEN) {
+			maze->flag[y] |= REACH;
+			maze->costs[y] = NIL;
+			link_cell(maze, dial, y, NIL);
+		}
+	}
+	while ((cell = pop_dial(maze, dial, &cost)) != NOTVISIT) {
+		for (dir = RIGHT; dir <= UP; dir++) {
+			next = next_cell(maze, cell, dir);
+			if (next != NOTVISIT && maze->flag[next] & OPEN) {
+				weigh_cell(maze, dial, next, cost + WEIGHT(maze, next), dir);
+			}
+		}
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Assigns reachability to a cell and, if cost is lower than its own, *
+ * moves it to the bucket of cost, recording the direction dir the    *
+ * water travelled to enter it                                        */
+void weigh_cell(maze_t *maze, dial_t *dial, int cell, int cost, int dir) {
+	STAT(maze->stats->visits++);
+	maze->flag[cell] |= REACH;
+	if (maze->costs[cell] < NIL || cost < maze->costs[cell]) {
+		STAT(maze->stats->relaxes += maze->costs[cell] >= NIL);
+		if (maze->flag[cell] & QUEUED) {
+			unlink_cell(maze, dial, cell, maze->costs[cell]);
+		}
+		maze->costs[cell] = cost;
+		maze->flag[cell] = (maze->flag[cell] & ~PARENT) | dir << PSHIFT;
+		link_cell(maze, dial, cell, cost);
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Removes and returns the first cell of the lowest key waiting, moving *
+ * key up to it, or returns NOTVISIT if no cell is waiting               */
+int pop_dial(maze_t *maze, dial_t *dial, int *key) {
+	int cell;
+	if (!dial->size) {
+		return NOTVISIT;
+	}
+	while (dial->head[*key % dial->nbuckets] == NOTVISIT) {
+		(*key)++;
+	}
+	cell = dial->head[*key % dial->nbuckets];
+	unlink_cell(maze, dial, cell, *key);
+	return cell;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Adds a cell to the bucket of key, at its tail or, stacked, its head */
+void link_cell(maze_t *maze, dial_t *dial, int cell, int key) {
+	int bucket = key % dial->nbuckets;
+	if (dial->stacked) {
+		dial->prev[cell] = NOTVISIT;
+		dial->next[cell] = dial->head[bucket];
+		if (dial->head[bucket] != NOTVISIT) {
+			dial->prev[dial->head[bucket]] = cell;
+		} else {
+			dial->tail[bucket] = cell;
+		}
+		dial->head[bucket] = cell;
+	} else {
+		dial->next[cell] = NOTVISIT;
+		dial->prev[cell] = dial->tail[bucket];
+		if (dial->tail[bucket] != NOTVISIT) {
+			dial->next[dial->tail[bucket]] = cell;
+		} else {
+			dial->head[bucket] = cell;
+		}
+		dial->tail[bucket] = cell;
+	}
+	maze->flag[cell] |= QUEUED;
+	dial->size++;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Removes a cell from the bucket of key, the one it was linked with */
+void unlink_cell(maze_t *maze, dial_t *dial, int cell, int key) {
+	int bucket = key % dial->nbuckets;
+	if (dial->prev[cell] != NOTVISIT) {
+		dial->next[dial->prev[cell]] = dial->next[cell];
+	} else {
+		dial->head[bucket] = dial->next[cell];
+	}
+	if (dial->next[cell] != NOTVISIT) {
+		dial->prev[dial->next[cell]] = dial->prev[cell];
+	} else {
+		dial->tail[bucket] = dial->prev[cell];
+	}
+	maze->flag[cell] &= ~QUEUED;
+	dial->size--;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Empties every bucket, leaving no cell marked as waiting */
+void drain_dial(maze_t *maze, dial_t *dial) {
+	int i, cell;
+	for (i = NIL; i < dial->nbuckets; i++) {
+		for (cell = dial->head[i]; cell != NOTVISIT; cell = dial->next[cell]) {
+			maze->flag[cell] &= ~QUEUED;
+		}
+		dial->head[i] = dial->tail[i] = NOTVISIT;
+	}
+	dial->size = NIL;
+}
+
+/***************************************************************************/
+
+/* Finds the cost from each entrance to each exit of a maze, if it has *
+ * none, from one flood for every WORDBITS entrances rather than one   *
+ * for each. Weighted mazes are flooded by weight                      */
+void matrix_maze(maze_t *maze) {
+	matrix_t *matrix;
+	int base;
+	if (maze->tabled) {
+		return;
+	}
+	matrix = reset_matrix(maze);
+	for (base = NIL; base < matrix->nentries && matrix->nexits;
+			base += WORDBITS) {
+		spread_entries(maze, matrix, base);
+	}
+	maze->tabled = TRUE;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Floods the maze from up to WORDBITS entrances from base at once. At   *
+ * each cost in turn, each cell due bits it has not yet seen takes them, *
+ * at its lowest cost from their entrances, and makes them due at its    *
+ * neighbours at the cost of entering each. An exit takes the cost as    *
+ * its cost from each entrance whose bit it takes. Once every exit has   *
+ * every bit, what is still due is dropped unvisited                     */
+void spread_entries(maze_t *maze, matrix_t *matrix, int base) {
+	int i, x, y, cell, bucket, cost, found = NIL, lanes;
+	int last = INDEX(maze, LAST_ROW, NIL);
+	uint64_t bits, fresh, *words;
+	lanes = matrix->nentries - base < WORDBITS ? matrix->nentries - base :
+		WORDBITS;
+	memset(matrix->words, NIL, (size_t)maze->rows * maze->cols *
+			matrix->stride * sizeof(*(matrix->words)));
+	for (i = NIL; i < lanes; i++) {
+		due_bits(maze, matrix, matrix->entries[base + i], 1ULL << i, NIL);
+	}
+	for (cost = NIL; matrix->waiting; cost++) {
+		bucket = cost % matrix->nbuckets;
+		for (i = NIL; i < matrix->size[bucket]; i++) {
+			cell = matrix->cells[bucket][i];
+			words = matrix->words + (size_t)cell * matrix->stride;
+			bits = words[1 + bucket] & ~words[NIL];
+			words[1 + bucket] = NIL;
+			if (!bits || found == lanes * matrix->nexits) {
+				continue;
+			}
+			STAT(maze->stats->visits++);
+			words[NIL] |= bits;
+			x = cell / maze->cols;
+			y = cell - x * maze->cols;
+			if (cell >= last) {
+				for (fresh = bits; fresh; fresh &= fresh - 1, found++) {
+					matrix->costs[(size_t)(base + __builtin_ctzll(fresh)) *
+						matrix->nexits + matrix->slot[y]] = cost;
+				}
+			}
+			if (y < LAST_COL) {
+				due_bits(maze, matrix, cell + 1, bits,
+						bucket + STEP(maze, cell + 1));
+			}
+			if (x < LAST_ROW) {
+				due_bits(maze, matrix, cell + maze->cols, bits,
+						bucket + STEP(maze, cell + maze->cols));
+			}
+			if (y > NIL) {
+				due_bits(maze, matrix, cell - 1, bits,
+						bucket + STEP(maze, cell - 1));
+			}
+			if (x > NIL) {
+				due_bits(maze, matrix, cell - maze->cols, bits,
+						bucket + STEP(maze, cell - maze->cols));
+			}
+		}
+		matrix->waiting -= matrix->size[bucket];
+		matrix->size[bucket] = NIL;
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Makes the bits an open cell has not seen due at it in bucket, which *
+ * may run up to nbuckets past the last, listing the cell there if     *
+ * nothing was due there yet                                           */
+void due_bits(maze_t *maze, matrix_t *matrix, int cell, uint64_t bits,
+		int bucket) {
+	uint64_t *words = matrix->words + (size_t)cell * matrix->stride;
+	int lim;
+	if (!(maze->flag[cell] & OPEN) || !(bits &= ~words[NIL])) {
+		return;
+	}
+	if (bucket >= matrix->nbuckets) {
+		bucket -= matrix->nbuckets;
+	}
+	if (!words[1 + bucket]) {
+		if (matrix->size[bucket] == matrix->lim[bucket]) {
+			lim = matrix->lim[bucket] ? matrix->lim[bucket] * 2 : maze->cols;
+			matrix->cells[bucket] = (int *)arena_grow(maze->arena,
+					matrix->cells[bucket], matrix->size[bucket] *
+					sizeof(**(matrix->cells)), lim * sizeof(**(matrix->cells)));
+			matrix->lim[bucket] = lim;
+		}
+		matrix->cells[bucket][matrix->size[bucket]++] = cell;
+		matrix->waiting++;
+	}
+	words[1 + bucket] |= bits;
+}
+
+/***************************************************************************/
+
+/* Toggles the cell at row x, column y of a maze solved with parents for  *
+ * every cell between wall and path, repairing only the costs that change *
+ * and the parents beside them, then finds the exit and path again.       *
+ * Returns the new cost, or NOTVISIT if there is no solution. A repaired  *
+ * cell takes the first neighbour a cost lower as its parent, so where    *
+ * shortest paths tie the one found may differ from a fresh solve's.      *
+ * A maze traversed by labels alone or flooded only in part is flooded   *
+ * first, its labels are dropped, and the costs of Stage 5 are found      *
+ * again if it is printed.                                                *
+ * Cells outside the maze are left alone                                  */
+int toggle_cell(maze_t *maze, int x, int y) {
+	int i, dir, cell, size = maze->rows * maze->cols;
+	if (x >= NIL && x < maze->rows && y >= NIL && y < maze->cols) {
+		if (maze->labelled || maze->partial) {
+			reflood_maze(maze);
+		}
+		assert(maze->solved && !maze->labelled && !maze->partial);
+		maze->labels = NULL;
+		if (!maze->dirty) {
+			maze->dirty = (int *)arena_alloc(maze->arena,
+					(size_t)size * 2 * sizeof(*(maze->dirty)));
+			reset_queue(maze->queue, maze->arena, size);
+		}
+		for (cell = maze->exit; cell != NOTVISIT && maze->costs[cell];
+				cell = parent_cell(maze, cell)) {
+			maze->flag[cell] &= ~SOLN;
+		}
+		if (cell != NOTVISIT) {
+			maze->flag[cell] &= ~SOLN;
+		}
+		maze->ndirty = NIL;
+		cell = INDEX(maze, x, y);
+		if (maze->flag[cell] & OPEN) {
+			close_cell(maze, cell);
+		} else {
+			open_cell(maze, cell);
+		}
+		for (i = NIL; i < maze->ndirty; i++) {
+			fix_parent(maze, cell = maze->dirty[i * 2]);
+			for (dir = RIGHT; dir <= UP; dir++) {
+				fix_parent(maze, next_cell(maze, cell, dir));
+			}
+		}
+		maze->cost = NIL;
+		maze->soln = FALSE;
+		if ((maze->exit = find_exit(maze)) != NOTVISIT) {
+			maze->cost = shortest_path(maze, maze->exit);
+			maze->soln = TRUE;
+		}
+		maze->tabled = FALSE;
+		if (maze->stages & 1 << STAGE5) {
+			matrix_maze(maze);
+		}
+	}
+	return maze->soln ? maze->cost : NOTVISIT;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Opens a wall, giving it the lowest cost its neighbours allow, and lets *
+ * the lower costs it brings spread to the cells beyond in queue order    */
+void open_cell(maze_t *maze, int cell) {
+	int dir, next, cost = cell < maze->cols ? NIL : NOTVISIT;
+	maze->flag[cell] |= OPEN;
+	maze->type[cell] = PATH;
+	for (dir = RIGHT; dir <= UP; dir++) {
+		next = next_cell(maze, cell, dir);
+		if (next != NOTVISIT && (maze->flag[next] & REACH) &&
+				(cost < NIL || maze->costs[next] + 1 < cost)) {
+			cost = maze->costs[next] + 1;
+		}
+	}
+	if (cost < NIL) {
+		return;
+	}
+	maze->flag[cell] |= REACH;
+	maze->costs[cell] = cost;
+	dirty_cell(maze, cell);
+	enqueue(maze->queue, cell);
+	while (maze->queue->size) {
+		cell = dequeue(maze->queue);
+		for (dir = RIGHT; dir <= UP; dir++) {
+			next = next_cell(maze, cell, dir);
+			if (next != NOTVISIT && (maze->flag[next] & OPEN) &&
+					(!(maze->flag[next] & REACH) ||
+					maze->costs[next] > maze->costs[cell] + 1)) {
+				maze->flag[next] |= REACH;
+				maze->costs[next] = maze->costs[cell] + 1;
+				dirty_cell(maze, next);
+				enqueue(maze->queue, next);
+			}
+		}
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Closes a path. The cells whose every cost-lower neighbour was lost are *
+ * marked a level at a time; each is seeded with the lowest cost its      *
+ * unmarked neighbours allow, and the seeds, least first, are flooded     *
+ * through the marked cells alone                                         */
+void close_cell(maze_t *maze, int cell) {
+	int i, dir, next, cost, reached = maze->flag[cell] & REACH;
+	maze->flag[cell] &= ~OPEN;
+	maze->type[cell] = WALL;
+	if (!reached) {
+		return;
+	}
+	maze->flag[cell] |= MARK;
+	dirty_cell(maze, cell);
+	enqueue(maze->queue, cell);
+	while (maze->queue->size) {
+		cell = dequeue(maze->queue);
+		for (dir = RIGHT; dir <= UP; dir++) {
+			next = next_cell(maze, cell, dir);
+			if (next != NOTVISIT && (maze->flag[next] & OPEN) &&
+					!(maze->flag[next] & MARK) &&
+					maze->costs[next] == maze->costs[cell] + 1 &&
+					!supported(maze, next)) {
+				maze->flag[next] |= MARK;
+				dirty_cell(maze, next);
+				enqueue(maze->queue, next);
+			}
+		}
+	}
+	for (i = NIL; i < maze->ndirty; i++) {
+		cell = maze->dirty[i * 2];
+		for (cost = NOTVISIT, dir = RIGHT; dir <= UP; dir++) {
+			next = next_cell(maze, cell, dir);
+			if (next != NOTVISIT && (maze->flag[next] & OPEN) &&
+					(maze->flag[next] & REACH) &&
+					!(maze->flag[next] & MARK) &&
+					(cost < NIL || maze->costs[next] + 1 < cost)) {
+				cost = maze->costs[next] + 1;
+			}
+		}
+		maze->dirty[i * 2 + 1] = maze->flag[cell] & OPEN ? cost : NOTVISIT;
+	}
+	for (i = NIL; i < maze->ndirty; i++) {
+		maze->flag[maze->dirty[i * 2]] &= ~REACH;
+		maze->costs[maze->dirty[i * 2]] = NOTVISIT;
+	}
+	qsort(maze->dirty, maze->ndirty, 2 * sizeof(*(maze->dirty)), cmp_seeds);
+	for (i = NIL; i < maze->ndirty || maze->queue->size;) {
+		if (i < maze->ndirty && maze->dirty[i * 2 + 1] < NIL) {
+			i++;
+		} else if (i < maze->ndirty && (!maze->queue->size ||
+				maze->dirty[i * 2 + 1] <= maze->costs[
+				maze->queue->cells[maze->queue->head]])) {
+			cell = maze->dirty[i * 2];
+			cost = maze->dirty[i++ * 2 + 1];
+			if (!(maze->flag[cell] & REACH) || cost < maze->costs[cell]) {
+				maze->flag[cell] |= REACH;
+				maze->costs[cell] = cost;
+				relax_cell(maze, cell);
+			}
+		} else {
+			relax_cell(maze, dequeue(maze->queue));
+		}
+	}
+	for (i = NIL; i < maze->ndirty; i++) {
+		maze->flag[maze->dirty[i * 2]] &= ~MARK;
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Checks whether a cell keeps its cost through an unmarked neighbour one *
+ * cost lower                                                             */
+int supported(maze_t *maze, int cell) {
+	int dir, next;
+	for (dir = RIGHT; dir <= UP; dir++) {
+		next = next_cell(maze, cell, dir);
+		if (next != NOTVISIT && (maze->flag[next] & OPEN) &&
+				!(maze->flag[next] & MARK) &&
+				(maze->flag[next] & REACH) &&
+				maze->costs[next] == maze->costs[cell] - 1) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Lowers the costs of the marked neighbours of a cell that can be reached *
+ * more cheaply through it, queueing each one lowered                      */
+void relax_cell(maze_t *maze, int cell) {
+	int dir, next;
+	for (dir = RIGHT; dir <= UP; dir++) {
+		next = next_cell(maze, cell, dir);
+		if (next != NOTVISIT && (maze->flag[next] & MARK) &&
+				(maze->flag[next] & OPEN) &&
+				(!(maze->flag[next] & REACH) ||
+				maze->costs[next] > maze->costs[cell] + 1)) {
+			maze->flag[next] |= REACH;
+			maze->costs[next] = maze->costs[cell] + 1;
+			enqueue(maze->queue, next);
+		}
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Records a cell a toggle changed */
+void dirty_cell(maze_t *maze, int cell) {
+	maze->dirty[maze->ndirty * 2] = cell;
+	maze->dirty[maze->ndirty++ * 2 + 1] = maze->costs[cell];
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Points a reached cell whose parent no longer lies a cost below it at the *
+ * first neighbour that does                                                */
+void fix_parent(maze_t *maze, int cell) {
+	int dir, next;
+	if (cell == NOTVISIT || !(maze->flag[cell] & REACH) ||
+			!maze->costs[cell]) {
+		return;
+	}
+	next = next_cell(maze, cell,
+			OPPOSITE((maze->flag[cell] & PARENT) >> PSHIFT));
+	if (next != NOTVISIT && (maze->flag[next] & REACH) &&
+			maze->costs[next] == maze->costs[cell] - 1) {
+		return;
+	}
+	for (dir = RIGHT; dir <= UP; dir++) {
+		next = next_cell(maze, cell, dir);
+		if (next != NOTVISIT && (maze->flag[next] & REACH) &&
+				maze->costs[next] == maze->costs[cell] - 1) {
+			maze->flag[cell] = (maze->flag[cell] & ~PARENT) |
+				OPPOSITE(dir) << PSHIFT;
+			return;
+		}
+	}
+}
+
+/***************************************************************************/
+
+/* Reads the next line into the row, returning whether there was one. The *
+ * first line sets the number of columns and sizes the sweep; an empty    *
+ * one ends the maze. Longer lines are truncated, shorter ones padded     */
+int read_row(arena_t *arena, sweep_t *sweep, FILE *fp) {
+	ssize_t got;
+	size_t width;
+	int n;
+	if ((got = getline(&sweep->line, &sweep->llim, fp)) <= NIL) {
+		return FALSE;
+	}
+	width = got - (sweep->line[got - 1] == NEWLINE);
+	if (!sweep->rows) {
+		if (!width) {
+			return FALSE;
+		}
+		sweep->cols = n = (int)width;
+		sweep->row = (char *)arena_alloc(arena, n);
+		sweep->label = (int *)arena_alloc(arena, n * sizeof(int));
+		sweep->parent = (int *)arena_alloc(arena, 2 * n * sizeof(int));
+		sweep->first = (int *)arena_alloc(arena, 2 * n * sizeof(int));
+		sweep->stamp = (int *)arena_alloc(arena, 2 * n * sizeof(int));
+		sweep->top = (uint8_t *)arena_alloc(arena, 2 * n);
+		sweep->keep = (uint8_t *)arena_alloc(arena, n);
+		memset(sweep->label, NOTVISIT, n * sizeof(int));
+		memset(sweep->stamp, NOTVISIT, 2 * n * sizeof(int));
+		memset(sweep->top, NIL, 2 * n);
+	}
+	if (width > (size_t)sweep->cols) {
+		width = sweep->cols;
+	}
+	memcpy(sweep->row, sweep->line, width);
+	memset(sweep->row + width, NIL, sweep->cols - width);
+	sweep->rows++;
+	return TRUE;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Joins each open cell of the row to the open cells left of and above it, *
+ * then relabels the row's components by their first cells, dropping the  *
+ * components of the row above that did not reach it. Returns whether any  *
+ * cell of the row is joined to the first row                              */
+int sweep_row(sweep_t *sweep) {
+	int y, root, n = sweep->cols, soln = FALSE;
+	for (y = NIL; y < 2 * n; y++) {
+		sweep->parent[y] = y;
+	}
+	for (y = NIL; y < n; y++) {
+		if (sweep->row[y] != PATH) {
+			continue;
+		}
+		sweep->top[n + y] = sweep->rows == 1;
+		if (y && sweep->row[y - 1] == PATH) {
+			join_nodes(sweep, n + y, n + y - 1);
+		}
+		if (sweep->label[y] != NOTVISIT) {
+			join_nodes(sweep, n + y, sweep->label[y]);
+		}
+	}
+	for (y = NIL; y < n; y++) {
+		sweep->label[y] = sweep->row[y] == PATH ?
+			find_node(sweep, n + y) : NOTVISIT;
+	}
+	for (y = NIL; y < n; y++) {
+		if ((root = sweep->label[y]) == NOTVISIT) {
+			continue;
+		}
+		if (sweep->stamp[root] != sweep->rows) {
+			sweep->stamp[root] = sweep->rows;
+			sweep->first[root] = y;
+			soln |= sweep->keep[y] = sweep->top[root];
+		}
+		sweep->label[y] = sweep->first[root];
+	}
+	for (y = NIL; y < n; y++) {
+		sweep->top[y] = sweep->label[y] == y && sweep->keep[y];
+	}
+	return soln;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Joins the components of two nodes, the first taking the second's root */
+void join_nodes(sweep_t *sweep, int a, int b) {
+	a = find_node(sweep, a);
+	b = find_node(sweep, b);
+	if (a != b) {
+		sweep->parent[a] = b;
+		sweep->top[b] |= sweep->top[a];
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Finds the root of a node's component, halving the path to it */
+int find_node(sweep_t *sweep, int node) {
+	while (sweep->parent[node] != node) {
+		node = sweep->parent[node] = sweep->parent[sweep->parent[node]];
+	}
+	return node;
+}
+
+/***************************************************************************/
+
+/* Handles maze output printing. With a stream set, each stage is written *
+ * with one fwrite, or in runs each CHUNK bytes; otherwise all stages are *
+ * left in the output buffer. Early termination prints Stage 2 alone      */
+maze_t *print_maze(maze_t *maze) {
+	out_t *out = maze->out;
+	reserve_out(out, maze->form == TEXTFORM ? ((size_t)maze->cols * 2 + 1) *
+			maze->rows + HEADSIZE : HEADSIZE);
+	if (maze->early) {
+		print_stage_2(maze, out);
+		flush_out(out, maze->fp);
+		return maze;
+	}
+	if (maze->stages & 1 << STAGE1) {
+		print_stage_1(maze, out);
+		flush_out(out, maze->fp);
+	}
+	if (maze->stages & 1 << STAGE2) {
+		print_stage_2(maze, out);
+		flush_out(out, maze->fp);
+	}
+	if (maze->stages & 1 << STAGE3) {
+		print_stage_3(maze, out);
+		flush_out(out, maze->fp);
+	}
+	if (maze->soln && maze->stages & 1 << STAGE4) {
+		print_stage_4(maze, out);
+		flush_out(out, maze->fp);
+	}
+	if (maze->tabled && maze->stages & 1 << STAGE5) {
+		print_stage_5(maze, out);
+		flush_out(out, maze->fp);
+	}
+	return maze;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Prints output of Stage 1 */
+void print_stage_1(maze_t *maze, out_t *out) {
+	int i, x, y;
+	char *line;
+	out_format(out, STAGENUM, STAGE1);
+	out_format(out, PRINT1, maze->rows, maze->cols);
+	if (maze->form == RUNSFORM) {
+		print_runs(maze, out, STAGE1);
+	}
+	for (x = i = NIL; x < maze->rows && maze->form == TEXTFORM; x++) {
+		line = out_line(out, maze->cols);
+		for (y = NIL; y < maze->cols; y++, i++) {
+			line = print_pair(line, maze->type[i]);
+		}
+	}
+	out_format(out, "\n");
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Prints output of Stage 2. A verdict alone leaves out the cells */
+void print_stage_2(maze_t *maze, out_t *out) {
+	int i, x, y;
+	char *line;
+	out_format(out, STAGENUM, STAGE2);
+	out_format(out, maze->soln ? PRINT2A : PRINT2B);
+	if (maze->form == RUNSFORM && maze->early != VERDICT) {
+		print_runs(maze, out, STAGE2);
+	}
+	for (x = i = NIL; x < maze->rows && maze->early != VERDICT &&
+			maze->form == TEXTFORM; x++) {
+		line = out_line(out, maze->cols);
+		for (y = NIL; y < maze->cols; y++, i++) {
+			if (maze->flag[i] & OPEN) {
+				if (maze->flag[i] & REACH) {
+					line = print_pair(line, REACHABLE);
+				} else {
+					line = print_pair(line, UNREACHABLE);
+				}
+			} else {
+				line = print_pair(line, maze->type[i]);
+			}
+		}
+	}
+	out_format(out, "\n");
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Prints output of Stage 3. Costs are only known throughout the maze *
+ * if it was fully flooded, and are only printed as text              */
+void print_stage_3(maze_t *maze, out_t *out) {
+	int i, x, y;
+	char *line;
+	out_format(out, STAGENUM, STAGE3);
+	if (maze->soln) {
+		out_format(out, PRINT3A, maze->cost);
+	} else {
+		out_format(out, PRINT3B);
+	}
+	for (x = i = NIL; x < maze->rows && !maze->partial &&
+			maze->form == TEXTFORM; x++) {
+		line = out_line(out, maze->cols);
+		for (y = NIL; y < maze->cols; y++, i++) {
+			if (maze->flag[i] & OPEN) {
+				if (maze->flag[i] & REACH) {
+					if (!(maze->costs[i] % 2)) {
+						line = print_cost(line, maze->costs[i]);
+					} else {
+						line = print_pair(line, REACHABLE);
+					}
+				} else {
+					line = print_pair(line, UNREACHABLE);
+				}
+			} else {
+				line = print_pair(line, maze->type[i]);
+			}
+		}
+	}
+	out_format(out, "\n");
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Prints output of Stage 4. Open cells off the path of a partly  *
+ * flooded maze are left blank, whether reachable or not           */
+void print_stage_4(maze_t *maze, out_t *out) {
+	int i, x, y;
+	char *line;
+	out_format(out, STAGENUM, STAGE4);
+	out_format(out, PRINT4);
+	if (maze->form == RUNSFORM) {
+		print_runs(maze, out, STAGE4);
+	} else if (maze->form == MOVEFORM) {
+		print_moves(maze, out);
+	}
+	for (x = i = NIL; x < maze->rows && maze->form == TEXTFORM; x++) {
+		line = out_line(out, maze->cols);
+		for (y = NIL; y < maze->cols; y++, i++) {
+			if (maze->flag[i] & OPEN) {
+				if ((maze->flag[i] & REACH) || maze->partial) {
+					if (maze->flag[i] & SOLN) {
+						if (!(maze->costs[i] % 2)) {
+							line = print_cost(line, maze->costs[i]);
+						} else {
+							line = print_pair(line, PATH);
+						}
+					} else {
+						line = print_pair(line, NONSOLUTION);
+					}
+				} else {
+					line = print_pair(line, UNREACHABLE);
+				}
+			} else {
+				line = print_pair(line, maze->type[i]);
+			}
+		}
+	}
+	out_format(out, "\n");
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Prints the grid of a stage as runs, row by row, each run of one      *
+ * character written with its count unless the character stands alone   *
+ * and flushed once CHUNK bytes are waiting                             */
+void print_runs(maze_t *maze, out_t *out, int stage) {
+	int x, y, i, run;
+	char c, *line;
+	for (x = i = NIL; x < maze->rows; x++, i += maze->cols) {
+		reserve_out(out, (size_t)maze->cols * 2 + 1);
+		line = out->buf + out->len;
+		for (y = NIL; y < maze->cols; y += run) {
+			c = run_char(maze, stage, i + y);
+			for (run = 1; y + run < maze->cols &&
+					run_char(maze, stage, i + y + run) == c; run++);
+			if (run > 1) {
+				line += sprintf(line, "%d", run);
+			}
+			*line++ = c;
+		}
+		*line++ = NEWLINE;
+		out->len = line - out->buf;
+		if (out->len >= CHUNK) {
+			flush_out(out, maze->fp);
+		}
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Character a cell has in the runs of a stage: its class as the text   *
+ * prints it, costs left out. In Stage 1 open cells are paths and every *
+ * other cell is a wall, so that no run is of a digit                   */
+char run_char(maze_t *maze, int stage, int cell) {
+	uint8_t flag = maze->flag[cell];
+	if (stage == STAGE1 || !(flag & OPEN)) {
+		return flag & OPEN ? PATH : WALL;
+	}
+	if (stage == STAGE2) {
+		return flag & REACH ? REACHABLE : UNREACHABLE;
+	}
+	if (!(flag & REACH) && !maze->partial) {
+		return UNREACHABLE;
+	}
+	return flag & SOLN ? PATH : NONSOLUTION;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Prints the path as the column of its entrance, then the direction of *
+ * each step from there as a letter of MOVES on one line, read back     *
+ * from the exit through parent directions                              */
+void print_moves(maze_t *maze, out_t *out) {
+	int cell;
+	size_t len;
+	char *line;
+	for (len = NIL, cell = maze->exit; cell >= maze->cols; len++) {
+		cell = parent_cell(maze, cell);
+	}
+	out_format(out, PRINT4M, cell);
+	reserve_out(out, len + 1);
+	line = out->buf + out->len + len;
+	*line = NEWLINE;
+	for (cell = maze->exit; cell >= maze->cols;
+			cell = parent_cell(maze, cell)) {
+		*--line = MOVES[(maze->flag[cell] & PARENT) >> PSHIFT];
+	}
+	out->len += len + 1;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Prints output of Stage 5: the columns of the exits, then a line for  *
+ * each entrance giving its column and its cost to each exit, or a dash *
+ * where it reaches none                                                */
+void print_stage_5(maze_t *maze, out_t *out) {
+	matrix_t *matrix = maze->matrix;
+	int *costs = matrix->costs;
+	int i, j;
+	out_format(out, STAGENUM, STAGE5);
+	out_format(out, PRINT5, matrix->nentries,
+			matrix->nentries == 1 ? "" : PLURAL, matrix->nexits,
+			matrix->nexits == 1 ? "" : PLURAL);
+	out_format(out, PRINT5X);
+	for (j = NIL; j < matrix->nexits; j++) {
+		out_format(out, PRINT5C, matrix->exits[j]);
+	}
+	out_format(out, "\n");
+	for (i = NIL; i < matrix->nentries; i++) {
+		out_format(out, PRINT5E, matrix->entries[i]);
+		for (j = NIL; j < matrix->nexits; j++, costs++) {
+			if (*costs >= NIL) {
+				out_format(out, PRINT5C, *costs);
+			} else {
+				out_format(out, PRINT5N);
+			}
+		}
+		out_format(out, "\n");
+	}
+	out_format(out, "\n");
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Renders the last two digits of a cell cost from the lookup table */
+char *print_cost(char *line, int cost) {
+	memcpy(line, DIGITS + 2 * (cost % 100), 2);
+	return line + 2;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Renders a cell character doubled */
+char *print_pair(char *line, char c) {
+	line[0] = line[1] = c;
+	return line + 2;
+}
+
+/***************************************************************************/
+
+/* Creates an output buffer with room for lim bytes */
+out_t *new_out(size_t lim) {
+	out_t *out = (out_t *)calloc(1, sizeof(*out));
+	assert(out);
+	out->buf = (char *)malloc(out->lim = lim);
+	assert(out->buf);
+	return out;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Makes sure lim more bytes fit in the output buffer */
+void reserve_out(out_t *out, size_t lim) {
+	if (out->len + lim > out->lim) {
+		out->buf = (char *)realloc(out->buf, out->lim = out->len + lim);
+		assert(out->buf);
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Appends formatted text to the output buffer, growing it if needed */
+void out_format(out_t *out, const char *format, ...) {
+	int n;
+	va_list args;
+	va_start(args, format);
+	n = vsnprintf(out->buf + out->len, out->lim - out->len, format, args);
+	va_end(args);
+	if ((size_t)n >= out->lim - out->len) {
+		out->buf = (char *)realloc(out->buf, out->lim = out->len + n + 1);
+		assert(out->buf);
+		va_start(args, format);
+		vsnprintf(out->buf + out->len, out->lim - out->len, format, args);
+		va_end(args);
+	}
+	out->len += n;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Reserves one rendered row of cols doubled cells and its newline in the *
+ * output buffer, returning where the first cell is to be written        */
+char *out_line(out_t *out, int cols) {
+	size_t width = (size_t)cols * 2 + 1;
+	char *line;
+	reserve_out(out, width);
+	line = out->buf + out->len;
+	out->len += width;
+	line[width - 1] = NEWLINE;
+	return line;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Writes out everything rendered so far and empties the buffer. Without *
+ * a stream the output is kept                                            */
+void flush_out(out_t *out, FILE *fp) {
+	if (fp) {
+		fwrite(out->buf, 1, out->len, fp);
+		out->len = NIL;
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Frees memory allocated to an output buffer */
+void free_out(out_t *out) {
+	free(out->buf);
+	free(out);
+}
+
+/***************************************************************************/
+
+#ifdef BFS_STATS
+/* Completes the counters of the last solve with what the queue and the *
+ * arena recorded of it                                                  */
+void count_stats(maze_t *maze) {
+	maze->stats->enqueues = maze->queue->enqueued;
+	maze->stats->peak = maze->queue->peak;
+	maze->stats->bytes = maze->arena->used + maze->out->lim;
+}
+#endif
+
+/***************************************************************************/
+
+/* Hashes text with XXH64, seed zero, reading it in native byte order */
+uint64_t hash_text(const char *text, size_t len) {
+	const char *end = text + len;
+	uint64_t h, lane, v[4] = {PRIME1 + PRIME2, PRIME2, NIL, - PRIME1};
+	uint32_t half;
+	int i;
+	if (len >= 32) {
+		for (; end - text >= 32; text += 32) {
+			for (i = NIL; i < 4; i++) {
+				memcpy(&lane, text + i * 8, sizeof(lane));
+				v[i] = hash_round(v[i], lane);
+			}
+		}
+		h = ROTL(v[0], 1) + ROTL(v[1], 7) + ROTL(v[2], 12) + ROTL(v[3], 18);
+		for (i = NIL; i < 4; i++) {
+			h = (h ^ hash_round(NIL, v[i])) * PRIME1 + PRIME4;
+		}
+	} else {
+		h = PRIME5;
+	}
+	for (h += len; end - text >= 8; text += 8) {
+		memcpy(&lane, text, sizeof(lane));
+		h ^= hash_round(NIL, lane);
+		h = ROTL(h, 27) * PRIME1 + PRIME4;
+	}
+	if (end - text >= 4) {
+		memcpy(&half, text, sizeof(half));
+		h ^= half * PRIME1;
+		h = ROTL(h, 23) * PRIME2 + PRIME3;
+		text += 4;
+	}
+	for (; text < end; text++) {
+		h ^= (uint8_t)*text * PRIME5;
+		h = ROTL(h, 11) * PRIME1;
+	}
+	h = (h ^ h >> 33) * PRIME2;
+	h = (h ^ h >> 29) * PRIME3;
+	return h ^ h >> 32;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Mixes eight bytes of input into an accumulator of the hash */
+uint64_t hash_round(uint64_t acc, uint64_t lane) {
+	acc += lane * PRIME2;
+	return ROTL(acc, 31) * PRIME1;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Returns the key of the options a maze is solved and printed with. *
+ * Engines that flood all of the maze share results, so only an      *
+ * engine that floods part of it is named                            */
+uint32_t result_key(maze_t *maze) {
+	int engine = maze->engine;
+	if (maze->weighted || maze->early || maze->stages & 1 << STAGE2 ||
+			(engine != BIDIR && engine != ASTAR && engine != JPS)) {
+		engine = QUEUE;
+	}
+	return maze->weighted | maze->early << 1 | maze->stages << 3 |
+		engine << 9;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Packs what printing a traversed maze reads into a result, grown in  *
+ * its arena: the class of each run of open cells, then their costs.   *
+ * Returns the result and sets its length                              */
+char *pack_result(maze_t *maze, size_t *len) {
+	result_t head;
+	pack_t pack;
+	int cell, run, class, size = maze->rows * maze->cols;
+	memset(&pack, NIL, sizeof(pack));
+	pack.arena = maze->arena;
+	pack.lim = sizeof(head) + size / 4 + ALIGN;
+	pack.buf = (uint8_t *)arena_alloc(pack.arena, pack.lim);
+	pack.len = sizeof(head);
+	for (cell = NIL; cell < size;) {
+		if (!(maze->flag[cell] & OPEN)) {
+			cell++;
+			continue;
+		}
+		class = cell_class(maze, cell);
+		for (run = NIL; cell < size && (!(maze->flag[cell] & OPEN) ||
+				cell_class(maze, cell) == class); cell++) {
+			run += maze->flag[cell] & OPEN;
+		}
+		put_bits(&pack, class, CLASSBITS);
+		put_gamma(&pack, run);
+	}
+	pack_costs(maze, &pack);
+	put_bits(&pack, NIL, 7);
+	memset(&head, NIL, sizeof(head));
+	memcpy(head.magic, RESULT, MAGICLEN);
+	head.hash = maze->hash;
+	head.key = result_key(maze);
+	head.rows = maze->rows;
+	head.cols = maze->cols;
+	head.cost = maze->cost;
+	head.soln = maze->soln;
+	head.partial = maze->partial;
+	head.exit = maze->exit;
+	head.size = pack.len - sizeof(head);
+	memcpy(pack.buf, &head, sizeof(head));
+	head.check = hash_text((char *)pack.buf + CHECKED, pack.len - CHECKED);
+	memcpy(pack.buf, &head, sizeof(head));
+	*len = pack.len;
+	return (char *)pack.buf;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Packs the cost of each cell that has one, row by row, as its change *
+ * from the cost its neighbours give it                                */
+void pack_costs(maze_t *maze, pack_t *pack) {
+	int x, y, cell, last = NIL;
+	for (x = cell = NIL; x < maze->rows; x++) {
+		for (y = NIL; y < maze->cols; y++, cell++) {
+			if (maze->costs[cell] != NOTVISIT) {
+				put_delta(pack, maze->costs[cell] -
+						cost_ref(maze, cell, y, last));
+				last = maze->costs[cell];
+			}
+		}
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Restores a parsed maze from a result packed for the same input and  *
+ * options, as if it had been traversed. Returns whether the result    *
+ * was whole, unchanged since it was packed and matched the maze; if   *
+ * it did not, the maze is left as it was parsed                       */
+int unpack_result(maze_t *maze, const char *data, size_t len) {
+	result_t head;
+	pack_t pack;
+	size_t i, size = (size_t)maze->rows * maze->cols;
+	if (len < sizeof(head)) {
+		return FALSE;
+	}
+	memcpy(&head, data, sizeof(head));
+	if (memcmp(head.magic, RESULT, MAGICLEN) ||
+			head.check != hash_text(data + CHECKED, len - CHECKED) ||
+			head.hash != maze->hash ||
+			head.key != result_key(maze) ||
+			head.rows != (uint32_t)maze->rows ||
+			head.cols != (uint32_t)maze->cols ||
+			(size_t)head.size != len - sizeof(head)) {
+		return FALSE;
+	}
+	memset(&pack, NIL, sizeof(pack));
+	pack.buf = (uint8_t *)data;
+	pack.len = sizeof(head);
+	pack.lim = len;
+	if (!unpack_cells(maze, &pack) || !unpack_costs(maze, &pack) ||
+			pack.len != pack.lim) {
+		for (i = NIL; i < size; i++) {
+			maze->flag[i] &= OPEN;
+			maze->costs[i] = NOTVISIT;
+		}
+		return FALSE;
+	}
+	maze->cost = head.cost;
+	maze->soln = head.soln;
+	maze->partial = head.partial;
+	maze->exit = head.exit;
+	maze->solved = TRUE;
+	return TRUE;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Restores the flags of each run of open cells, giving the cells with a *
+ * cost zero until their costs are read. Returns whether the runs cover  *
+ * the open cells exactly                                                */
+int unpack_cells(maze_t *maze, pack_t *pack) {
+	int cell = NIL, size = maze->rows * maze->cols;
+	uint64_t class, run;
+	while (cell < size) {
+		if (!(maze->flag[cell] & OPEN)) {
+			cell++;
+			continue;
+		}
+		if (!get_bits(pack, CLASSBITS, &class) || !get_gamma(pack, &run)) {
+			return FALSE;
+		}
+		for (; run && cell < size; cell++) {
+			if (maze->flag[cell] & OPEN) {
+				maze->flag[cell] |= (class << 1) & (REACH | SOLN);
+				maze->costs[cell] = class & COSTED ? NIL : NOTVISIT;
+				run--;
+			}
+		}
+		if (run) {
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Restores the cost of each cell that has one, in the order they were *
+ * packed. Returns whether every cost was read and none is negative    */
+int unpack_costs(maze_t *maze, pack_t *pack) {
+	int x, y, cell, delta, last = NIL;
+	long cost;
+	for (x = cell = NIL; x < maze->rows; x++) {
+		for (y = NIL; y < maze->cols; y++, cell++) {
+			if (maze->costs[cell] != NOTVISIT) {
+				if (!get_delta(pack, &delta) || (cost = (long)cost_ref(maze,
+						cell, y, last) + delta) < NIL || cost > INT32_MAX) {
+					return FALSE;
+				}
+				maze->costs[cell] = last = (int)cost;
+			}
+		}
+	}
+	return TRUE;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Returns the class of an open cell in a packed result */
+int cell_class(maze_t *maze, int cell) {
+	return (maze->flag[cell] & (REACH | SOLN)) >> 1 |
+		(maze->costs[cell] != NOTVISIT ? COSTED : FALSE);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Returns the cost a cell in column y is coded against: that of the   *
+ * cell to its left, or else above it, if it has one, or else the last *
+ * cost coded                                                          */
+int cost_ref(maze_t *maze, int cell, int y, int last) {
+	if (y && maze->costs[cell - 1] != NOTVISIT) {
+		return maze->costs[cell - 1];
+	}
+	if (cell >= maze->cols && maze->costs[cell - maze->cols] != NOTVISIT) {
+		return maze->costs[cell - maze->cols];
+	}
+	return last;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Writes the low n bits of bits, at most 32, the lowest first, growing *
+ * the result as its bytes fill                                         */
+void put_bits(pack_t *pack, uint64_t bits, int n) {
+	pack->bits |= (bits & (((uint64_t)1 << n) - 1)) << pack->nbits;
+	for (pack->nbits += n; pack->nbits >= 8; pack->nbits -= 8) {
+		if (pack->len == pack->lim) {
+			pack->buf = (uint8_t *)arena_grow(pack->arena, pack->buf,
+					pack->len, pack->lim * 2);
+			pack->lim *= 2;
+		}
+		pack->buf[pack->len++] = (uint8_t)pack->bits;
+		pack->bits >>= 8;
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Writes a value of one or more as an Elias gamma code: as many zeros *
+ * as it has bits after its top one, a one, then those bits            */
+void put_gamma(pack_t *pack, uint64_t value) {
+	int n;
+	for (n = NIL; value >> (n + 1); n++);
+	put_bits(pack, NIL, n);
+	put_bits(pack, 1, 1);
+	put_bits(pack, value, n);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Writes the change in cost from a cell's reference. A step of one is a *
+ * one and its sign; anything else is a zero and the gamma code of the   *
+ * change folded to unsigned, plus one                                   */
+void put_delta(pack_t *pack, int delta) {
+	if (delta == 1 || delta == - 1) {
+		put_bits(pack, delta < NIL ? 3 : 1, 2);
+	} else {
+		put_bits(pack, NIL, 1);
+		put_gamma(pack, (delta < NIL ? - (uint64_t)delta * 2 - 1 :
+				(uint64_t)delta * 2) + 1);
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Reads the next n bits, at most 32, returning whether the result held *
+ * that many                                                            */
+int get_bits(pack_t *pack, int n, uint64_t *bits) {
+	for (; pack->nbits < n; pack->nbits += 8) {
+		if (pack->len == pack->lim) {
+			return FALSE;
+		}
+		pack->bits |= (uint64_t)pack->buf[pack->len++] << pack->nbits;
+	}
+	*bits = pack->bits & (((uint64_t)1 << n) - 1);
+	pack->bits >>= n;
+	pack->nbits -= n;
+	return TRUE;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Reads a gamma code of 32 bits at most, returning whether it was whole */
+int get_gamma(pack_t *pack, uint64_t *value) {
+	int n;
+	uint64_t bit = NIL;
+	for (n = NIL; n <= 32 && get_bits(pack, 1, &bit) && !bit; n++);
+	if (!bit || !get_bits(pack, n, value)) {
+		return FALSE;
+	}
+	*value |= (uint64_t)1 << n;
+	return TRUE;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Reads a change in cost, returning whether it was whole and fits */
+int get_delta(pack_t *pack, int *delta) {
+	uint64_t bit, value;
+	if (!get_bits(pack, 1, &bit)) {
+		return FALSE;
+	}
+	if (bit) {
+		if (!get_bits(pack, 1, &bit)) {
+			return FALSE;
+		}
+		*delta = bit ? - 1 : 1;
+		return TRUE;
+	}
+	if (!get_gamma(pack, &value) || --value > (uint64_t)INT32_MAX * 2) {
+		return FALSE;
+	}
+	*delta = value & 1 ? - (int)(value / 2) - 1 : (int)(value / 2);
+	return TRUE;
+}
+
+/***************************************************************************/
+
+/* Frees memory allocated to an arena and every block it holds */
+void free_arena(arena_t *arena) {
+	int i;
+	for (i = NIL; i < arena->nblocks; i++) {
+		free(arena->blocks[i]);
+	}
+	free(arena->blocks);
+	free(arena);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Frees memory allocated to a queue, its ring being in the arena */
+void free_queue(queue_t *queue) {
+	free(queue);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Frees memory allocated to a team and the cells its threads claimed */
+void free_team(team_t *team) {
+	int i;
+	for (i = NIL; i < team->lim; i++) {
+		free(team->members[i].cells);
+	}
+	free(team->members);
+	free(team->counts);
+	free(team);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Frees memory allocated to a maze and everything it owns. The arrays of *
+ * each engine went back with the arena                                   */
+int free_maze(maze_t *maze) {
+	free_arena(maze->arena);
+	free_queue(maze->queue);
+	free(maze->bits);
+	free(maze->level);
+	free(maze->meet);
+	free_team(maze->team);
+	free(maze->tiles);
+	free(maze->dial);
+	free(maze->matrix);
+	free_out(maze->out);
+	STAT(free(maze->stats));
+	free(maze);
+	return EXIT_SUCCESS;
+}
+
+/***************************************************************************/
+
+/* Creates a solver: a maze with every stage printed, flooded by the *
+ * queue engine on one thread                                        */
+bfs_t *bfs_new(void) {
+	maze_t *maze = new_maze();
+	maze->stages = STAGES;
+	maze->threads = 1;
+	maze->exit = NOTVISIT;
+	return maze;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Selects the engine of later solves by its name in ENGINES */
+int bfs_engine(bfs_t *bfs, const char *name) {
+	int engine;
+	const char *engines[] = ENGINES;
+	for (engine = NIL; engines[engine]; engine++) {
+		if (!strcmp(engines[engine], name)) {
+			bfs->engine = engine;
+			return NIL;
+		}
+	}
+	return NOTVISIT;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Sets the threads of the parallel engine, one at least */
+void bfs_threads(bfs_t *bfs, int threads) {
+	bfs->threads = threads > 1 ? threads : 1;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Turns weighted cells of later loads on or off */
+void bfs_weights(bfs_t *bfs, int on) {
+	bfs->weighted = on != FALSE;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Sets the stages later solves are for, leaving out bits of no stage */
+void bfs_stages(bfs_t *bfs, int stages) {
+	bfs->stages = stages & ALLSTAGES;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Selects the form stages are rendered in by its name in FORMS */
+int bfs_form(bfs_t *bfs, const char *name) {
+	int form;
+	const char *forms[] = FORMS;
+	for (form = NIL; forms[form]; form++) {
+		if (!strcmp(forms[form], name)) {
+			bfs->form = form;
+			return NIL;
+		}
+	}
+	return NOTVISIT;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Parses a maze from a caller's buffer, checking a binary one first. The *
+ * buffer is only read                                                    */
+int bfs_load(bfs_t *bfs, const char *buf, size_t len) {
+	char *text = (char *)buf;
+	if (is_binary(text, len) && !(len = binary_len(text, len))) {
+		parse_text(bfs, text, NIL);
+		return NOTVISIT;
+	}
+	parse_text(bfs, text, len);
+	return NIL;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Traverses the loaded maze once, for its cost as well as its stages, *
+ * returning the cost                                                   */
+int bfs_solve(bfs_t *bfs) {
+	cover_stages(bfs, 1 << STAGE3);
+	return bfs_cost(bfs);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Toggles a cell of the maze, solving it first if need be. Engines that *
+ * leave out parents have the maze solved again by the queue engine      *
+ * before the first toggle, as do bidir, astar and jps when they flood   *
+ * only part of it. Weighted mazes are left as they are                  */
+int bfs_toggle(bfs_t *bfs, int x, int y) {
+	int engine = bfs->engine, partial = engine == BITBOARD || engine == TILED;
+	if (bfs->weighted) {
+		return NOTVISIT;
+	}
+	if (bfs->solved && !bfs->dirty && partial) {
+		clear_maze(bfs);
+	}
+	if (!bfs->solved) {
+		bfs->engine = partial ? QUEUE : engine;
+		traverse_maze(bfs);
+		bfs->engine = engine;
+	}
+	return toggle_cell(bfs, x, y);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Number of rows of the loaded maze */
+int bfs_rows(const bfs_t *bfs) {
+	return bfs->rows;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Number of columns of the loaded maze */
+int bfs_cols(const bfs_t *bfs) {
+	return bfs->cols;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Cost of the solved maze's path, or NOTVISIT if it has none or it was *
+ * traversed by labels alone                                            */
+int bfs_cost(const bfs_t *bfs) {
+	return bfs->soln && !bfs->labelled ? bfs->cost : NOTVISIT;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Copies out the costs of the reached cells, NOTVISIT for the rest */
+size_t bfs_costs(const bfs_t *bfs, int *costs, size_t lim) {
+	size_t i, size = (size_t)bfs->rows * bfs->cols;
+	for (i = NIL; i < size && i < lim; i++) {
+		costs[i] = bfs->flag[i] & REACH ? bfs->costs[i] : NOTVISIT;
+	}
+	return size;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Copies out whether each cell is reached */
+size_t bfs_reach(const bfs_t *bfs, unsigned char *reach, size_t lim) {
+	size_t i, size = (size_t)bfs->rows * bfs->cols;
+	for (i = NIL; i < size && i < lim; i++) {
+		reach[i] = (bfs->flag[i] & REACH) != NIL;
+	}
+	return size;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Copies out the cost from each entrance to each exit, finding them once *
+ * per load or toggle                                                     */
+size_t bfs_matrix(bfs_t *bfs, int *costs, size_t lim) {
+	size_t size;
+	matrix_maze(bfs);
+	size = (size_t)bfs->matrix->nentries * bfs->matrix->nexits;
+	memcpy(costs, bfs->matrix->costs, (size < lim ? size : lim) *
+			sizeof(*costs));
+	return size;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Number of entrances of the loaded maze */
+int bfs_entrances(bfs_t *bfs) {
+	matrix_maze(bfs);
+	return bfs->matrix->nentries;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Number of exits of the loaded maze */
+int bfs_exits(bfs_t *bfs) {
+	matrix_maze(bfs);
+	return bfs->matrix->nexits;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Labels the components of the loaded maze, once per load or toggle */
+int bfs_label(bfs_t *bfs) {
+	if (!bfs->labels) {
+		label_maze(bfs);
+	}
+	return bfs->ncomps;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Compares the labels of two cells, labelling the maze first if need be */
+int bfs_joined(bfs_t *bfs, int a, int b) {
+	int size = bfs->rows * bfs->cols;
+	if (a < NIL || a >= size || b < NIL || b >= size) {
+		return FALSE;
+	}
+	bfs_label(bfs);
+	return bfs->labels[a] != NOTVISIT && bfs->labels[a] == bfs->labels[b];
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Checks whether a cell's label lies in the first row, labelling the maze *
+ * first if need be                                                        */
+int bfs_reachable(bfs_t *bfs, int cell) {
+	if (cell < NIL || cell >= bfs->rows * bfs->cols) {
+		return FALSE;
+	}
+	bfs_label(bfs);
+	return bfs->labels[cell] != NOTVISIT && bfs->labels[cell] < bfs->cols;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Copies out the path by following parents back from the exit, filling *
+ * the buffer from its end, once the maze is traversed far enough for it */
+size_t bfs_path(bfs_t *bfs, int *cells, size_t lim) {
+	int cell;
+	size_t i, len;
+	cover_stages(bfs, 1 << STAGE4);
+	cell = bfs->exit;
+	len = bfs->exit != NOTVISIT ? (size_t)bfs->cost + 1 : NIL;
+	if (len && bfs->weighted) {
+		for (len = 1; cell >= bfs->cols; len++) {
+			cell = parent_cell(bfs, cell);
+		}
+		cell = bfs->exit;
+	}
+	if (len && len <= lim) {
+		for (i = len; i-- > NIL; cell = parent_cell(bfs, cell)) {
+			cells[i] = cell;
+		}
+	}
+	return len;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Renders the stages into the output buffer with no stream set, then *
+ * copies as much as fits. The maze is traversed again first if it was *
+ * not traversed far enough for them, and Stage 5 has its costs found  */
+size_t bfs_render(bfs_t *bfs, int stages, char *buf, size_t lim) {
+	int saved = bfs->stages;
+	FILE *fp = bfs->fp;
+	size_t len;
+	cover_stages(bfs, stages & ALLSTAGES);
+	bfs->out->len = NIL;
+	bfs->stages = stages & ALLSTAGES;
+	bfs->fp = NULL;
+	if (bfs->stages & 1 << STAGE5) {
+		matrix_maze(bfs);
+	}
+	print_maze(bfs);
+	bfs->stages = saved;
+	bfs->fp = fp;
+	len = bfs->out->len;
+	memcpy(buf, bfs->out->buf, len < lim ? len : lim);
+	return len;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Releases a solver */
+void bfs_free(bfs_t *bfs) {
+	free_maze(bfs);
+}
+
+/***************************************************************************/
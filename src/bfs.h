@@ -0,0 +1,126 @@
+/***************************************************************************/
+
+/* Public interface of the bfs library. A solver holds one maze at a time *
+ * and the memory of its solves, reused from one maze to the next. A      *
+ * solver must not be shared between threads, but any number may be used *
+ * at once, one to a thread. Cells are numbered row by row from zero, and *
+ * a cost of -1 marks a cell that is not reached                          */
+
+/***************************************************************************/
+
+#ifndef BFS_H
+#define BFS_H
+
+#include <stddef.h>
+
+/* Symbols exported from the shared library */
+#if defined(__GNUC__)
+#define BFS_API __attribute__((visibility("default")))
+#else
+#define BFS_API
+#endif
+
+/* Stages rendered by bfs_render, combined with |. BFS_STAGES are the  *
+ * four the command line prints by default, and BFS_STAGE5 the costs   *
+ * from each entrance to each exit                                     */
+#define BFS_STAGE1 0x02
+#define BFS_STAGE2 0x04
+#define BFS_STAGE3 0x08
+#define BFS_STAGE4 0x10
+#define BFS_STAGES 0x1e
+#define BFS_STAGE5 0x20
+
+/* Solver handle */
+typedef struct maze_s bfs_t;
+
+/* Creates a solver using the queue engine on one thread */
+BFS_API bfs_t *bfs_new(void);
+
+/* Selects the engine of later solves by name: queue, bitboard, hybrid,  *
+ * bidir, parallel, tiled, astar or jps. Returns 0, or -1 if there is no *
+ * such engine                                                           */
+BFS_API int    bfs_engine(bfs_t *bfs, const char *name);
+
+/* Sets the threads the parallel engine floods each maze with */
+BFS_API void   bfs_threads(bfs_t *bfs, int threads);
+
+/* Turns weighted cells on or off for later loads. Weighted, a digit 0 to *
+ * 9 is an open cell costing that much to enter, and a path costs one.    *
+ * Costs and the path are then by weight, and toggles change nothing      */
+BFS_API void   bfs_weights(bfs_t *bfs, int on);
+
+/* Sets the stages later solves are for, combined as for bfs_render, *
+ * BFS_STAGES by default. A solve finds the cost and what else its   *
+ * stages print: the path with Stage 4, and the cost of every cell   *
+ * with Stage 2. bfs_path and bfs_render solve again for what they   *
+ * need and the last solve left out                                  */
+BFS_API void   bfs_stages(bfs_t *bfs, int stages);
+
+/* Selects the form bfs_render renders stages in by name: text, as the  *
+ * command line prints them by default, rle, runs of the cells of each  *
+ * row, or moves, the path as a letter for each step. Returns 0, or -1  *
+ * if there is no such form                                             */
+BFS_API int    bfs_form(bfs_t *bfs, const char *name);
+
+/* Loads a maze from text or from one binary maze, replacing the last. *
+ * Text is copied; the wall plane of a binary maze may be read in      *
+ * place, so buf must outlive its solve. Returns 0, or -1 if buf holds *
+ * a malformed binary maze                                             */
+BFS_API int    bfs_load(bfs_t *bfs, const char *buf, size_t len);
+
+/* Solves the loaded maze, if it is not yet solved. Returns the cost of *
+ * the shortest path, or -1 if there is none                            */
+BFS_API int    bfs_solve(bfs_t *bfs);
+
+/* Toggles the cell at row x, column y of the solved maze between wall *
+ * and path and repairs the solution. Returns the cost as bfs_solve    */
+BFS_API int    bfs_toggle(bfs_t *bfs, int x, int y);
+
+/* Dimensions of the loaded maze */
+BFS_API int    bfs_rows(const bfs_t *bfs);
+BFS_API int    bfs_cols(const bfs_t *bfs);
+
+/* Cost of the shortest path of the solved maze, or -1 if there is none *
+ * or it is not yet found, as after rendering Stage 1 or 2 alone        */
+BFS_API int    bfs_cost(const bfs_t *bfs);
+
+/* Copies the cost of each cell into costs, and whether it is reached  *
+ * into reach, as far as lim allows. Each returns the number of cells  */
+BFS_API size_t bfs_costs(const bfs_t *bfs, int *costs, size_t lim);
+BFS_API size_t bfs_reach(const bfs_t *bfs, unsigned char *reach, size_t lim);
+
+/* Finds the cost from each entrance to each exit of the loaded maze,  *
+ * unless found since it was loaded or last toggled, with one flood    *
+ * for every 64 entrances. bfs_matrix copies them into costs as far as *
+ * lim allows, a row for each entrance with a cost for each exit, both *
+ * left to right, and returns the number of costs                      */
+BFS_API size_t bfs_matrix(bfs_t *bfs, int *costs, size_t lim);
+BFS_API int    bfs_entrances(bfs_t *bfs);
+BFS_API int    bfs_exits(bfs_t *bfs);
+
+/* Labels the open cells of the loaded maze with the components they lie *
+ * in, unless they are labelled since it was loaded or last toggled, and *
+ * returns the number of components. Each query below labels the maze    *
+ * first if need be and then takes constant time                         */
+BFS_API int    bfs_label(bfs_t *bfs);
+
+/* Whether open cells a and b are joined by a path, and whether an open *
+ * cell is joined to an entrance. Walls and cells outside the maze are  *
+ * joined to nothing                                                    */
+BFS_API int    bfs_joined(bfs_t *bfs, int a, int b);
+BFS_API int    bfs_reachable(bfs_t *bfs, int cell);
+
+/* Copies the cells of the shortest path, entrance first, into cells if *
+ * lim holds them all, solving the maze for it first if need be.        *
+ * Returns the number of cells, 0 with no solution                      */
+BFS_API size_t bfs_path(bfs_t *bfs, int *cells, size_t lim);
+
+/* Renders the stages chosen as the command line prints them into buf, *
+ * as far as lim allows, unterminated, solving the maze for them first *
+ * if need be. Returns the length rendered                             */
+BFS_API size_t bfs_render(bfs_t *bfs, int stages, char *buf, size_t lim);
+
+/* Releases a solver and all of its memory */
+BFS_API void   bfs_free(bfs_t *bfs);
+
+#endif
@@ -0,0 +1,1745 @@
+/***************************************************************************/
+
+/* Program concept and description : Command line front end of the bfs     *
+ * library. Solves the maze in each file named, or on stdin if none, and   *
+ * prints the stages chosen. Input is mapped from a file path or read from *
+ * stdin in large blocks. In batch mode many mazes are solved in one run,  *
+ * each reusing the arena and output buffer of the one before. With more   *
+ * than one thread the mazes become jobs shared out to workers, each with  *
+ * its own maze, which take jobs from their own deque and steal from the   *
+ * tails of the others when theirs runs dry. Output is written in input    *
+ * order. -B writes mazes in binary form, -S streams each input a row at a *
+ * time and -t toggles cells of each maze once it is solved. -c and -C     *
+ * keep the result of each maze solved, in memory and on disk, and print a *
+ * repeat of it from there. -D instead serves mazes framed with their      *
+ * lengths on a socket, an event loop handing each request to a pool of    *
+ * workers that keep their mazes, and so their memory, from one request to *
+ * the next                                                                */
+
+/***************************************************************************/
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#include "maze.h"
+
+/* Command line usage */
+#define USAGE "usage: %s [-b] [-B] [-c entries] [-C dir] [-d delim]" \
+              " [-D addr] [-e engine] [-f form] [-F bytes] [-H]" \
+              " [-j threads] [-L] [-s stages] [-S] [-t x,y ...]" \
+              " [-T text | json] [-w] [-x | -X] [file ...]\n"
+#define OPTIONS "bBc:C:d:D:e:f:F:Hj:Ls:St:T:wxX"
+
+/* Size of each block read from a stream */
+#define BLOCKSIZE (1 << 20)
+
+/* Jobs a pool holds at once. Once this many are queued or waiting to be *
+ * written, reading stops until the oldest is written                    */
+#define WINDOW    256
+
+/* Results kept in memory by default when -C is given without -c */
+#define CACHESIZE 256
+
+/* Name of a result in the cache directory, from its hash and key */
+#define RESNAME  "%s/%016llx%08x"
+#define RESTEMP  ".XXXXXX"
+
+/* Server constants. A frame is a header and then its body, of at most  *
+ * FRAMEMAX bytes unless -F says otherwise. Requests are read READSIZE  *
+ * bytes at a time at least, and the request buffers of every           *
+ * connection together hold at most BUFFERS frames of the largest size  */
+#define FRAMEMAX  (1U << 25)
+#define READSIZE  (1 << 16)
+#define BUFFERS   8
+#define BACKLOG   128
+#define MAXEVENTS 64
+
+/* Reply formats and statuses of frame headers */
+#define TEXTREPLY 0     /* Stages as the command line prints them */
+#define PACKREPLY 1     /* Result packed as the cache keeps it */
+#define REPLYOK   0     /* Maze was solved            */
+#define REPLYBAD  1     /* Request could not be solved */
+
+/* Printing related constants */
+#define MAZEHEAD "Maze %d (%s)\n"
+#define SWEEPNUM "Stage %d (forward sweep)\n=======================\n"
+#define TOGGLED  "Toggled %d,%d\n"
+#define STDIN    "stdin"
+#define BADBIN   "%s: malformed binary maze\n"
+#define NOSTATS  "%s: built without BFS_STATS\n"
+#define BADADDR  "%s: %s\n"
+
+/* Statistics formats, chosen by -T */
+#define STATTEXT 1
+#define STATJSON 2
+#define STATLINE "maze %d: visits %llu enqueues %llu relaxes %llu peak %d" \
+                 " bytes %zu read %.3f ms traverse %.3f ms print %.3f ms" \
+                 " toggle %.3f ms\n"
+#define STATOBJ  "{\"maze\":%d,\"visits\":%llu,\"enqueues\":%llu," \
+                 "\"relaxes\":%llu,\"peak\":%d,\"bytes\":%zu," \
+                 "\"read_ms\":%.3f,\"traverse_ms\":%.3f,\"print_ms\":%.3f," \
+                 "\"toggle_ms\":%.3f}\n"
+
+/***************************************************************************/
+
+/* Structure naming convention */
+typedef struct opts_s  opts_t;
+typedef struct text_s  text_t;
+typedef struct job_s   job_t;
+typedef struct deque_s deque_t;
+typedef struct worker_s worker_t;
+typedef struct pool_s  pool_t;
+typedef struct cache_s cache_t;
+typedef struct entry_s entry_t;
+typedef struct frame_s frame_t;
+typedef struct conn_s  conn_t;
+typedef struct server_s server_t;
+
+/* Option structure */
+struct opts_s {
+	int     batch;  /* Inputs hold many mazes     */
+	int     convert; /* Write mazes in binary form */
+	int     stream; /* Sweep inputs a row at a time */
+	int    *toggles; /* Rows and columns toggled after solving */
+	int     ntoggles; /* Number of cells toggled  */
+	int     list;   /* stdin lists input files    */
+	int     head;   /* Print a header per maze    */
+	char   *delim;  /* Line between batched mazes */
+	int     engine; /* Traversal engine used      */
+	int     stages; /* Bit of each stage printed  */
+	int     form;   /* Form stages are printed in */
+	int     early;  /* Stop at the first exit reached */
+	int     stats;  /* Format of solve statistics, if kept */
+	int     weighted; /* Digits are cells of that cost */
+	int     threads; /* Number of worker threads  */
+	int     mazes;  /* Number of mazes solved     */
+	int     climit; /* Results kept in memory, or NOTVISIT if unset */
+	char   *cdir;   /* Directory results are kept in, if any */
+	char   *serve;  /* Address mazes are served on, if any */
+	size_t  fmax;   /* Largest request body served */
+	pool_t *pool;   /* Workers, if multithreaded  */
+	cache_t *cache; /* Results of solved mazes, if kept */
+};
+
+/* Input text structure. An input held while jobs point into it, *
+ * released by whichever of the reader and its jobs lets go last */
+struct text_s {
+	char   *text;   /* Loaded input               */
+	size_t  len;    /* Length of the input        */
+	int     mapped; /* Input was mapped from file */
+	char   *name;   /* Copy of the input's name   */
+	int     refs;   /* Reader and jobs still using it */
+};
+
+/* Job structure */
+struct job_s {
+	text_t *input;  /* Input the maze came from   */
+	char   *text;   /* Text of the maze           */
+	size_t  len;    /* Length of the text         */
+	int     num;    /* Position in input order    */
+	char   *buf;    /* Rendered output            */
+	size_t  size;   /* Length of rendered output  */
+	int     done;   /* Rendered output is ready   */
+};
+
+/* Deque structure. A worker owns the jobs in slots [head, tail), taken *
+ * modulo WINDOW, taking them from the head while other workers steal   *
+ * from the tail                                                        */
+struct deque_s {
+	pthread_mutex_t lock;
+	int     slots[WINDOW]; /* Jobs dealt to the worker */
+	int     head;   /* Next job for the owner     */
+	int     tail;   /* End of the owned jobs      */
+};
+
+/* Worker structure */
+struct worker_s {
+	pool_t   *pool; /* Pool the worker belongs to */
+	int       id;   /* Index of the worker's deque */
+	pthread_t thread;
+};
+
+/* Pool structure. Job n lies in slot n modulo WINDOW of the jobs, from *
+ * when it is queued until its output is written                        */
+struct pool_s {
+	job_t    jobs[WINDOW]; /* Mazes queued or waiting to be written */
+	int      added; /* Jobs queued so far         */
+	int      written; /* Jobs written so far      */
+	int      pending; /* Jobs queued and not yet taken */
+	int      closed; /* No more jobs will be queued */
+	text_t  *input; /* Input being read, if any   */
+	deque_t *deques; /* One deque per worker      */
+	worker_t *workers; /* Worker threads          */
+	int      threads; /* Number of workers        */
+	opts_t  *opts;  /* Options the mazes are solved with */
+	pthread_mutex_t lock;
+	pthread_cond_t  done; /* Signalled as jobs finish */
+	pthread_cond_t  ready; /* Signalled as jobs are queued */
+};
+
+/* Cache structure. Results of solved mazes in a hash table by hash and *
+ * key, and in a list from the most to the least recently used, which   *
+ * is dropped first once more than lim are held. Results are also kept  *
+ * as files in dir, if set, where other runs find them                  */
+struct cache_s {
+	entry_t **buckets; /* Chains of entries by hash */
+	int      nbuckets; /* Number of buckets, a power of two */
+	entry_t *newest; /* Most recently used entry  */
+	entry_t *oldest; /* Least recently used entry */
+	int      size;  /* Number of entries          */
+	int      lim;   /* Entries held at most       */
+	char    *dir;   /* Directory of result files, or NULL */
+	pthread_mutex_t lock;
+};
+
+/* Frame header. The length of the body follows in network byte order,  *
+ * then its format and, in a request, the stages printed as -s sets     *
+ * them, or zero for those of the command line; in a reply, its status  */
+struct frame_s {
+	uint32_t len;   /* Bytes of the body          */
+	uint8_t  format; /* TEXTREPLY or PACKREPLY    */
+	uint8_t  arg;   /* Stages asked for, or status */
+	uint16_t spare; /* Zero                       */
+};
+
+/* Connection structure. Requests are read into a buffer and solved one *
+ * at a time; while one is solved the socket is not watched, and its    *
+ * reply is written before the next is taken from the buffer            */
+struct conn_s {
+	int      fd;    /* Socket of the connection   */
+	char    *buf;   /* Bytes read and not yet answered */
+	size_t   len;   /* Number of bytes read       */
+	size_t   lim;   /* Capacity of the buffer     */
+	char    *reply; /* Reply being written        */
+	size_t   rlen;  /* Length of the reply        */
+	size_t   rlim;  /* Capacity of the reply      */
+	size_t   sent;  /* Bytes of the reply written */
+	int      busy;  /* A worker is solving a request */
+	int      watched; /* Socket is in the epoll set */
+	conn_t  *queue; /* Next connection in its queue */
+	conn_t  *prev;  /* Connection before it       */
+	conn_t  *next;  /* Connection after it        */
+};
+
+/* Server structure. The event loop owns the sockets and the workers own *
+ * a maze each, passing connections between them in two queues: those    *
+ * with a request to solve and those with a reply to write, the loop     *
+ * woken by an eventfd as replies are ready                              */
+struct server_s {
+	opts_t  *opts;  /* Options the mazes are solved with */
+	int      epfd;  /* Epoll set of the loop      */
+	int      lfd;   /* Listening socket           */
+	int      efd;   /* Eventfd replies are signalled on */
+	int      sfd;   /* Signalfd the loop stops on */
+	conn_t  *conns; /* Every open connection      */
+	conn_t  *jobs;  /* Connections with a request to solve */
+	conn_t **tail;  /* Link the next job is put in */
+	conn_t  *done;  /* Connections with a reply to write */
+	size_t   held;  /* Bytes of every request buffer */
+	size_t   room;  /* Bytes a request buffer grows to at most */
+	pthread_t *threads; /* Worker threads         */
+	int      nthreads; /* Number of workers       */
+	int      stop;  /* Workers are to finish      */
+	pthread_mutex_t lock;
+	pthread_cond_t  ready; /* Signalled as jobs are queued */
+};
+
+/* Entry structure. A result and the maze it was packed from */
+struct entry_s {
+	uint64_t hash;  /* Hash of the input          */
+	uint32_t key;   /* Options the maze was solved with */
+	char    *data;  /* Packed result              */
+	size_t   len;   /* Length of the result       */
+	entry_t *chain; /* Next entry in its bucket   */
+	entry_t *newer; /* Entry used next after it   */
+	entry_t *older; /* Entry used last before it  */
+};
+
+/***************************************************************************/
+
+/* Function prototypes */
+int     read_opts(opts_t *opts, int argc, char **argv);
+void    use_opts(maze_t *maze, opts_t *opts);
+void    solve_list(maze_t *maze, opts_t *opts);
+void    solve_input(maze_t *maze, opts_t *opts, char *path);
+void    solve_batch(maze_t *maze, opts_t *opts, char *text, size_t len,
+		char *name);
+void    solve_binary(maze_t *maze, opts_t *opts, char *text, size_t len,
+		char *name);
+void    solve_maze(maze_t *maze, opts_t *opts, char *text, size_t len,
+		char *name);
+void    run_maze(maze_t *maze, opts_t *opts, char *text, size_t len,
+		int num);
+void    traverse_cached(maze_t *maze, opts_t *opts);
+#ifdef BFS_STATS
+void    print_stats(maze_t *maze, opts_t *opts, int num);
+double  lap_ms(double *start);
+#endif
+int     is_delim(char *line, size_t len, char *delim);
+void    stream_input(maze_t *maze, opts_t *opts, char *path);
+pool_t *new_pool(opts_t *opts);
+void    hold_text(pool_t *pool, char *text, size_t len, int mapped,
+		char *name);
+void    drop_text(pool_t *pool, text_t *input);
+void    add_job(pool_t *pool, char *text, size_t len, int num);
+void    write_jobs(pool_t *pool, int wait);
+void    run_pool(pool_t *pool);
+void   *run_worker(void *arg);
+int     next_job(pool_t *pool, int id);
+int     take_job(pool_t *pool, int id);
+void    run_job(pool_t *pool, maze_t *maze, job_t *job);
+void    free_pool(pool_t *pool);
+char   *load_text(char *path, size_t *len, int *mapped);
+void    free_text(char *text, size_t len, int mapped);
+char   *read_text(FILE *fp, size_t *len);
+char   *map_text(char *path, size_t *len);
+cache_t *new_cache(int lim, char *dir);
+int     find_result(cache_t *cache, maze_t *maze);
+void    keep_result(cache_t *cache, maze_t *maze);
+entry_t *find_entry(cache_t *cache, uint64_t hash, uint32_t key);
+void    add_entry(cache_t *cache, uint64_t hash, uint32_t key,
+		const char *data, size_t len);
+void    touch_entry(cache_t *cache, entry_t *entry);
+void    unlink_entry(cache_t *cache, entry_t *entry);
+void    drop_entry(cache_t *cache, entry_t *entry);
+char   *result_path(cache_t *cache, maze_t *maze, uint32_t key);
+void    write_result(maze_t *maze, char *path, char *data, size_t len);
+void    free_cache(cache_t *cache);
+void    serve(opts_t *opts);
+int     listen_on(char *addr);
+void    accept_conns(server_t *server);
+void    read_conn(server_t *server, conn_t *conn);
+void    take_request(server_t *server, conn_t *conn);
+void    write_conn(server_t *server, conn_t *conn);
+void    finish_conns(server_t *server);
+void    watch_conn(server_t *server, conn_t *conn);
+void    close_conn(server_t *server, conn_t *conn);
+void   *serve_worker(void *arg);
+void    answer_request(server_t *server, maze_t *maze, conn_t *conn);
+void    toggle_maze(maze_t *maze, opts_t *opts);
+
+/***************************************************************************/
+
+/* Handles processing of the mazes named on the command line, or of the *
+ * maze on stdin if none                                                */
+int main(int argc, char **argv) {
+	opts_t opts;
+	maze_t *maze = new_maze();
+	int i = read_opts(&opts, argc, argv);
+	maze->fp = stdout;
+	if (opts.climit || opts.cdir) {
+		opts.cache = new_cache(opts.climit, opts.cdir);
+	}
+	use_opts(maze, &opts);
+	if (opts.threads > 1 && opts.engine != PARALLEL && !opts.convert &&
+			!opts.stream && !opts.serve) {
+		opts.pool = new_pool(&opts);
+	}
+	if (opts.serve) {
+		serve(&opts);
+	} else if (opts.list) {
+		solve_list(maze, &opts);
+	} else if (i == argc) {
+		solve_input(maze, &opts, NULL);
+	}
+	for (; i < argc && !opts.serve; i++) {
+		solve_input(maze, &opts, argv[i]);
+	}
+	if (opts.pool) {
+		run_pool(opts.pool);
+		free_pool(opts.pool);
+	}
+	if (opts.cache) {
+		free_cache(opts.cache);
+	}
+	free(opts.toggles);
+	return free_maze(maze);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Parses command line options, returning the index of the first file.  *
+ * -b splits each input into mazes at lines equal to the delimiter set  *
+ * by -d (a blank line by default), -H prints a header before each      *
+ * maze, -j solves mazes on that many threads (0 for one per processor) *
+ * or, with the parallel engine, each maze on that many threads in turn *
+ * and -L reads the paths of the inputs from stdin, one per line. -e    *
+ * selects the traversal engine: queue (the default), bitboard, hybrid, *
+ * bidir, parallel, tiled, astar or jps, and -s the stages printed, as  *
+ * digits, 5 adding the costs from each entrance to each exit. bidir,   *
+ * astar and jps flood all the maze only if Stage 2 is printed;         *
+ * otherwise Stage 3 gives just the cost and Stage 4 leaves every open  *
+ * cell off the path blank. -f prints the stages as text (the default), *
+ * as rle, runs of each row's cells with no costs, or as moves, the     *
+ * headlines and the path as the steps it takes from its entrance. -x   *
+ * stops at the first exit reached and prints only the Stage 2 verdict  *
+ * and -X prints it with the cells reached by then. -B writes each maze *
+ * to stdout in binary form instead of solving it, and -S streams each  *
+ * input as one text maze, printing only Stage 2 as a forward sweep     *
+ * sees it. Each -t toggles the cell at row x, column y of every maze   *
+ * once it is solved and prints the stages again; engines that leave    *
+ * out parents give way to queue and -x and -X are ignored with it. -w  *
+ * reads digits as open cells costing that much to enter, solved from a *
+ * bucket queue whatever the engine; it leaves out -t, and it does not  *
+ * carry over to -B or -S. -T writes what each solve did and how long   *
+ * each phase took to stderr, as text or JSON, if the program was built *
+ * with BFS_STATS. -c keeps the results of that many mazes in memory    *
+ * and -C keeps every result as a file in that directory as well, made  *
+ * if need be, with CACHESIZE in memory unless -c says otherwise. A     *
+ * maze whose input and options match a kept result is printed from it  *
+ * without being traversed. Results are not kept with -t. -D serves     *
+ * mazes sent to addr, a socket path or [host:]port, on as many workers *
+ * as -j sets, in place of any files, until it is interrupted; -B, -L,  *
+ * -S and -t do not apply to it. -F sets the largest request it takes,  *
+ * in bytes, FRAMEMAX by default; larger ones close their connection    */
+int read_opts(opts_t *opts, int argc, char **argv) {
+	int c;
+	char *end;
+	const char *engines[] = ENGINES, *forms[] = FORMS;
+	memset(opts, NIL, sizeof(*opts));
+	opts->delim = "";
+	opts->climit = NOTVISIT;
+	opts->threads = 1;
+	opts->stages = STAGES;
+	opts->fmax = FRAMEMAX;
+	while ((c = getopt(argc, argv, OPTIONS)) != - 1) {
+		switch (c) {
+			case 'b':
+				opts->batch = TRUE;
+				break;
+			case 'B':
+				opts->convert = TRUE;
+				break;
+			case 'c':
+				if ((opts->climit = atoi(optarg)) < 0) {
+					fprintf(stderr, USAGE, argv[0]);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'C':
+				opts->cdir = optarg;
+				break;
+			case 'd':
+				opts->delim = optarg;
+				break;
+			case 'D':
+				opts->serve = optarg;
+				break;
+			case 'e':
+				for (opts->engine = NIL; engines[opts->engine] &&
+						strcmp(engines[opts->engine], optarg);
+						opts->engine++);
+				if (!engines[opts->engine]) {
+					fprintf(stderr, USAGE, argv[0]);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'f':
+				for (opts->form = NIL; forms[opts->form] &&
+						strcmp(forms[opts->form], optarg); opts->form++);
+				if (!forms[opts->form]) {
+					fprintf(stderr, USAGE, argv[0]);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'F':
+				opts->fmax = strtoul(optarg, &end, 10);
+				if (*end || !opts->fmax || opts->fmax > UINT32_MAX) {
+					fprintf(stderr, USAGE, argv[0]);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'H':
+				opts->head = TRUE;
+				break;
+			case 'j':
+				if ((opts->threads = atoi(optarg)) < 1) {
+					opts->threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+				}
+				break;
+			case 'L':
+				opts->list = TRUE;
+				break;
+			case 'w':
+				opts->weighted = TRUE;
+				break;
+			case 'x':
+				opts->early = VERDICT;
+				break;
+			case 'X':
+				opts->early = REACHED;
+				break;
+			case 'S':
+				opts->stream = TRUE;
+				break;
+			case 't':
+				opts->toggles = (int *)realloc(opts->toggles,
+						(opts->ntoggles + 1) * 2 * sizeof(int));
+				assert(opts->toggles);
+				if (sscanf(optarg, "%d,%d", opts->toggles +
+						opts->ntoggles * 2, opts->toggles +
+						opts->ntoggles * 2 + 1) != 2) {
+					fprintf(stderr, USAGE, argv[0]);
+					exit(EXIT_FAILURE);
+				}
+				opts->ntoggles++;
+				break;
+			case 'T':
+				opts->stats = !strcmp(optarg, "text") ? STATTEXT :
+					!strcmp(optarg, "json") ? STATJSON : NIL;
+				if (!opts->stats) {
+					fprintf(stderr, USAGE, argv[0]);
+					exit(EXIT_FAILURE);
+				}
+#ifndef BFS_STATS
+				fprintf(stderr, NOSTATS, argv[0]);
+				exit(EXIT_FAILURE);
+#endif
+				break;
+			case 's':
+				for (opts->stages = NIL; *optarg >= '0' + STAGE1 &&
+						*optarg <= '0' + STAGE5; optarg++) {
+					opts->stages |= 1 << (*optarg - '0');
+				}
+				if (*optarg || !opts->stages) {
+					fprintf(stderr, USAGE, argv[0]);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			default:
+				fprintf(stderr, USAGE, argv[0]);
+				exit(EXIT_FAILURE);
+		}
+	}
+	if (opts->weighted) {
+		opts->ntoggles = NIL;
+	}
+	if (opts->climit == NOTVISIT) {
+		opts->climit = opts->cdir ? CACHESIZE : NIL;
+	}
+	if (opts->ntoggles) {
+		opts->climit = NIL;
+		opts->cdir = NULL;
+		if (opts->engine == BITBOARD || opts->engine == BIDIR ||
+				opts->engine == TILED || opts->engine == ASTAR ||
+				opts->engine == JPS) {
+			opts->engine = QUEUE;
+		}
+		opts->early = FALSE;
+	}
+	return optind;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Sets how a maze is solved and printed from the options */
+void use_opts(maze_t *maze, opts_t *opts) {
+	maze->engine = opts->engine;
+	maze->stages = opts->stages;
+	maze->form = opts->form;
+	maze->early = opts->early;
+	maze->threads = opts->threads;
+	maze->weighted = opts->weighted;
+	maze->caching = opts->cache != NULL;
+}
+
+/***************************************************************************/
+
+/* Solves the input at each path listed on stdin */
+void solve_list(maze_t *maze, opts_t *opts) {
+	size_t len, width;
+	char *text = read_text(stdin, &len), *line = text, *eol;
+	while (line < text + len) {
+		if (!(eol = (char *)memchr(line, NEWLINE, text + len - line))) {
+			eol = text + len;
+		}
+		width = eol - line;
+		if (width && line[width - 1] == '\r') {
+			width--;
+		}
+		if (width) {
+			line[width] = '\0';
+			solve_input(maze, opts, line);
+		}
+		line = eol + 1;
+	}
+	free_text(text, len, FALSE);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Solves the maze, or in batch mode each maze, in the file at path, or *
+ * on stdin if path is NULL. Binary input is always read as a batch     */
+void solve_input(maze_t *maze, opts_t *opts, char *path) {
+	size_t len;
+	int mapped;
+	char *text;
+	if (opts->stream) {
+		stream_input(maze, opts, path);
+		return;
+	}
+	text = load_text(path, &len, &mapped);
+	if (opts->pool) {
+		hold_text(opts->pool, text, len, mapped, path ? path : STDIN);
+	}
+	if (is_binary(text, len)) {
+		solve_binary(maze, opts, text, len, path ? path : STDIN);
+	} else if (opts->batch) {
+		solve_batch(maze, opts, text, len, path ? path : STDIN);
+	} else {
+		solve_maze(maze, opts, text, len, path ? path : STDIN);
+	}
+	if (opts->pool) {
+		drop_text(opts->pool, opts->pool->input);
+		opts->pool->input = NULL;
+	} else {
+		free_text(text, len, mapped);
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Splits text at delimiter lines and solves each non-empty maze between *
+ * them                                                                  */
+void solve_batch(maze_t *maze, opts_t *opts, char *text, size_t len,
+		char *name) {
+	char *end = text + len, *start = text, *line = text, *eol;
+	while (line < end) {
+		if (!(eol = (char *)memchr(line, NEWLINE, end - line))) {
+			eol = end;
+		}
+		if (is_delim(line, eol - line, opts->delim)) {
+			if (line > start) {
+				solve_maze(maze, opts, start, line - start, name);
+			}
+			start = eol + (eol < end);
+		}
+		line = eol + (eol < end);
+	}
+	if (end > start) {
+		solve_maze(maze, opts, start, end - start, name);
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Solves and prints one maze, reusing the allocations of the last one, *
+ * or queues it as a job for the workers                                */
+void solve_maze(maze_t *maze, opts_t *opts, char *text, size_t len,
+		char *name) {
+	opts->mazes++;
+	if (opts->convert) {
+		write_binary(parse_text(maze, text, len), stdout);
+		return;
+	}
+	if (opts->pool) {
+		add_job(opts->pool, text, len, opts->mazes);
+		return;
+	}
+	if (opts->head) {
+		out_format(maze->out, MAZEHEAD, opts->mazes, name);
+	}
+	run_maze(maze, opts, text, len, opts->mazes);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Parses, traverses and prints a maze, then toggles its cells. A maze *
+ * with a kept result is restored from it instead of traversed, and    *
+ * one without has its result kept. Built with BFS_STATS, times each   *
+ * phase and reports the solve if -T asked for it                      */
+void run_maze(maze_t *maze, opts_t *opts, char *text, size_t len,
+		int num) {
+	STAT(double start = lap_ms(NULL));
+	(void)num;
+	parse_text(maze, text, len);
+	STAT(maze->stats->read_ms = lap_ms(&start));
+	traverse_cached(maze, opts);
+	STAT(maze->stats->traverse_ms = lap_ms(&start));
+	print_maze(maze);
+	STAT(maze->stats->print_ms = lap_ms(&start));
+	toggle_maze(maze, opts);
+	STAT(maze->stats->toggle_ms = lap_ms(&start));
+	STAT(print_stats(maze, opts, num));
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Traverses a parsed maze, or restores it from its kept result, keeping *
+ * the result of a maze that had none. Results hold no Stage 5, so its   *
+ * costs are found again for a restored maze, and no parents, so a maze  *
+ * printed as moves is always traversed                                  */
+void traverse_cached(maze_t *maze, opts_t *opts) {
+	if (!opts->cache || maze->form == MOVEFORM ||
+			!find_result(opts->cache, maze)) {
+		traverse_maze(maze);
+		if (opts->cache) {
+			keep_result(opts->cache, maze);
+		}
+	} else if (maze->stages & 1 << STAGE5) {
+		matrix_maze(maze);
+	}
+}
+
+#ifdef BFS_STATS
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Writes the counters and phase times of the last solve to stderr */
+void print_stats(maze_t *maze, opts_t *opts, int num) {
+	stats_t *stats = maze->stats;
+	if (!opts->stats) {
+		return;
+	}
+	count_stats(maze);
+	fprintf(stderr, opts->stats == STATJSON ? STATOBJ : STATLINE, num,
+			(unsigned long long)stats->visits,
+			(unsigned long long)stats->enqueues,
+			(unsigned long long)stats->relaxes, stats->peak, stats->bytes,
+			stats->read_ms, stats->traverse_ms, stats->print_ms,
+			stats->toggle_ms);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Returns the milliseconds since start on the monotonic clock and moves *
+ * start to now. With no start, returns now                              */
+double lap_ms(double *start) {
+	struct timespec ts;
+	double now, lap;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	now = ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+	if (!start) {
+		return now;
+	}
+	lap = now - *start;
+	*start = now;
+	return lap;
+}
+#endif
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Solves each binary maze of the input in turn, checking that the whole *
+ * of it lies within the input before it is parsed                      */
+void solve_binary(maze_t *maze, opts_t *opts, char *text, size_t len,
+		char *name) {
+	size_t size;
+	char *end = text + len;
+	while (text < end) {
+		if (!(size = binary_len(text, end - text))) {
+			fprintf(stderr, BADBIN, name);
+			exit(EXIT_FAILURE);
+		}
+		solve_maze(maze, opts, text, size, name);
+		text += size;
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Checks whether a line, less any carriage return, equals the delimiter */
+int is_delim(char *line, size_t len, char *delim) {
+	if (len && line[len - 1] == '\r') {
+		len--;
+	}
+	return len == strlen(delim) && !memcmp(line, delim, len);
+}
+
+/***************************************************************************/
+
+/* Streams the maze in the file at path, or on stdin if path is NULL, *
+ * printing each row of Stage 2 as it is swept and the verdict after  *
+ * the last, under a header of its own. A cell shows as reached once  *
+ * the rows read so far join it to an entrance, so cells reached only *
+ * by way of rows below show as not reached, unlike the Stage 2 of a  *
+ * traversal; the verdict is exact                                    */
+void stream_input(maze_t *maze, opts_t *opts, char *path) {
+	sweep_t sweep;
+	out_t *out = maze->out;
+	FILE *fp = stdin;
+	int y, soln = FALSE;
+	char *line;
+	if (path && !(fp = fopen(path, "rb"))) {
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+	opts->mazes++;
+	if (opts->head) {
+		out_format(out, MAZEHEAD, opts->mazes, path ? path : STDIN);
+	}
+	out_format(out, SWEEPNUM, STAGE2);
+	reset_arena(maze->arena);
+	memset(&sweep, NIL, sizeof(sweep));
+	while (read_row(maze->arena, &sweep, fp)) {
+		soln = sweep_row(&sweep);
+		line = out_line(out, sweep.cols);
+		for (y = NIL; y < sweep.cols; y++) {
+			if (sweep.label[y] == NOTVISIT) {
+				line = print_pair(line, sweep.row[y]);
+			} else if (sweep.top[sweep.label[y]]) {
+				line = print_pair(line, REACHABLE);
+			} else {
+				line = print_pair(line, UNREACHABLE);
+			}
+		}
+		if (out->len >= BLOCKSIZE) {
+			flush_out(out, maze->fp);
+		}
+	}
+	out_format(out, soln ? PRINT2A : PRINT2B);
+	out_format(out, "\n");
+	flush_out(out, maze->fp);
+	free(sweep.line);
+	if (fp != stdin) {
+		fclose(fp);
+	}
+}
+
+/***************************************************************************/
+
+/* Creates an empty pool and starts as many worker threads as the options *
+ * ask for, each solving mazes as the options set once jobs are queued    */
+pool_t *new_pool(opts_t *opts) {
+	int i, threads = opts->threads;
+	pool_t *pool = (pool_t *)calloc(1, sizeof(*pool));
+	assert(pool);
+	pool->deques = (deque_t *)calloc(threads, sizeof(*(pool->deques)));
+	pool->workers = (worker_t *)calloc(threads, sizeof(*(pool->workers)));
+	assert(pool->deques && pool->workers);
+	pool->threads = threads;
+	pool->opts = opts;
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->done, NULL);
+	pthread_cond_init(&pool->ready, NULL);
+	for (i = NIL; i < threads; i++) {
+		pthread_mutex_init(&pool->deques[i].lock, NULL);
+	}
+	for (i = NIL; i < threads; i++) {
+		pool->workers[i].pool = pool;
+		pool->workers[i].id = i;
+		if (pthread_create(&pool->workers[i].thread, NULL, run_worker,
+				pool->workers + i)) {
+			perror("pthread_create");
+			exit(EXIT_FAILURE);
+		}
+	}
+	return pool;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Holds a loaded input for the jobs queued from it, the reader keeping *
+ * one reference of its own until it has queued them all                */
+void hold_text(pool_t *pool, char *text, size_t len, int mapped,
+		char *name) {
+	text_t *input = (text_t *)malloc(sizeof(*input));
+	assert(input);
+	input->text = text;
+	input->len = len;
+	input->mapped = mapped;
+	input->name = strdup(name);
+	input->refs = 1;
+	assert(input->name);
+	pool->input = input;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Lets go of an input, unmapping or freeing it once nothing holds it */
+void drop_text(pool_t *pool, text_t *input) {
+	int refs;
+	pthread_mutex_lock(&pool->lock);
+	refs = --input->refs;
+	pthread_mutex_unlock(&pool->lock);
+	if (!refs) {
+		free_text(input->text, input->len, input->mapped);
+		free(input->name);
+		free(input);
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Queues a maze of the input being read, numbered num in input order, *
+ * on the deques in turn. Output already done is written first, and a  *
+ * full window waits for its oldest job to be written                  */
+void add_job(pool_t *pool, char *text, size_t len, int num) {
+	job_t *job;
+	deque_t *deque = pool->deques + pool->added % pool->threads;
+	write_jobs(pool, pool->added - pool->written == WINDOW);
+	job = memset(pool->jobs + pool->added % WINDOW, NIL, sizeof(*job));
+	job->input = pool->input;
+	job->text = text;
+	job->len = len;
+	job->num = num;
+	pthread_mutex_lock(&deque->lock);
+	deque->slots[deque->tail++ % WINDOW] = pool->added % WINDOW;
+	pthread_mutex_unlock(&deque->lock);
+	pthread_mutex_lock(&pool->lock);
+	job->input->refs++;
+	pool->added++;
+	pool->pending++;
+	pthread_cond_signal(&pool->ready);
+	pthread_mutex_unlock(&pool->lock);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Writes the output of each job, in input order, that is done and has *
+ * every job before it written, freeing its slot. With wait, first     *
+ * waits for the oldest job not yet written to be done                 */
+void write_jobs(pool_t *pool, int wait) {
+	job_t *job;
+	int done;
+	while (pool->written < pool->added) {
+		job = pool->jobs + pool->written % WINDOW;
+		pthread_mutex_lock(&pool->lock);
+		while (wait && !job->done) {
+			pthread_cond_wait(&pool->done, &pool->lock);
+		}
+		done = job->done;
+		pthread_mutex_unlock(&pool->lock);
+		if (!done) {
+			return;
+		}
+		fwrite(job->buf, 1, job->size, stdout);
+		free(job->buf);
+		job->buf = NULL;
+		pool->written++;
+		wait = FALSE;
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Once every input is read, tells the workers no more jobs will come, *
+ * writes the output of the jobs left in input order and waits for the *
+ * workers to finish                                                   */
+void run_pool(pool_t *pool) {
+	int i;
+	pthread_mutex_lock(&pool->lock);
+	pool->closed = TRUE;
+	pthread_cond_broadcast(&pool->ready);
+	pthread_mutex_unlock(&pool->lock);
+	while (pool->written < pool->added) {
+		write_jobs(pool, TRUE);
+	}
+	for (i = NIL; i < pool->threads; i++) {
+		pthread_join(pool->workers[i].thread, NULL);
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Body of a worker thread, solving jobs with a maze of its own until the *
+ * pool is closed and no deque has any left                               */
+void *run_worker(void *arg) {
+	worker_t *worker = (worker_t *)arg;
+	maze_t *maze = new_maze();
+	int job;
+	use_opts(maze, worker->pool->opts);
+	while ((job = next_job(worker->pool, worker->id)) != NOTVISIT) {
+		run_job(worker->pool, maze, worker->pool->jobs + job);
+	}
+	free_maze(maze);
+	return NULL;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Takes a job for a worker, waiting while none is queued. Returns the *
+ * slot of the job, or NOTVISIT once the pool is closed and every job  *
+ * has been taken                                                      */
+int next_job(pool_t *pool, int id) {
+	int job;
+	while ((job = take_job(pool, id)) == NOTVISIT) {
+		pthread_mutex_lock(&pool->lock);
+		while (!pool->pending && !pool->closed) {
+			pthread_cond_wait(&pool->ready, &pool->lock);
+		}
+		if (!pool->pending) {
+			pthread_mutex_unlock(&pool->lock);
+			return NOTVISIT;
+		}
+		pthread_mutex_unlock(&pool->lock);
+	}
+	pthread_mutex_lock(&pool->lock);
+	pool->pending--;
+	pthread_mutex_unlock(&pool->lock);
+	return job;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Takes the oldest job from a worker's own deque or, failing that, steals *
+ * the newest job from the next deque that has one. Returns NOTVISIT if    *
+ * every deque is empty                                                    */
+int take_job(pool_t *pool, int id) {
+	int i, job = NOTVISIT;
+	deque_t *deque = pool->deques + id;
+	pthread_mutex_lock(&deque->lock);
+	if (deque->head < deque->tail) {
+		job = deque->slots[deque->head++ % WINDOW];
+	}
+	pthread_mutex_unlock(&deque->lock);
+	for (i = 1; job == NOTVISIT && i < pool->threads; i++) {
+		deque = pool->deques + (id + i) % pool->threads;
+		pthread_mutex_lock(&deque->lock);
+		if (deque->head < deque->tail) {
+			job = deque->slots[--deque->tail % WINDOW];
+		}
+		pthread_mutex_unlock(&deque->lock);
+	}
+	return job;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Solves one job, keeping a copy of its output for the writer and letting *
+ * go of its input before the job is marked done                           */
+void run_job(pool_t *pool, maze_t *maze, job_t *job) {
+	maze->out->len = NIL;
+	if (pool->opts->head) {
+		out_format(maze->out, MAZEHEAD, job->num, job->input->name);
+	}
+	run_maze(maze, pool->opts, job->text, job->len, job->num);
+	job->buf = (char *)malloc(maze->out->len ? maze->out->len : 1);
+	assert(job->buf);
+	memcpy(job->buf, maze->out->buf, job->size = maze->out->len);
+	drop_text(pool, job->input);
+	pthread_mutex_lock(&pool->lock);
+	job->done = TRUE;
+	pthread_cond_broadcast(&pool->done);
+	pthread_mutex_unlock(&pool->lock);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Frees memory allocated to a pool whose workers have finished */
+void free_pool(pool_t *pool) {
+	int i;
+	for (i = NIL; i < pool->threads; i++) {
+		pthread_mutex_destroy(&pool->deques[i].lock);
+	}
+	pthread_mutex_destroy(&pool->lock);
+	pthread_cond_destroy(&pool->done);
+	pthread_cond_destroy(&pool->ready);
+	free(pool->deques);
+	free(pool->workers);
+	free(pool);
+}
+
+/***************************************************************************/
+
+/* Loads the whole of the file at path, or of stdin if path is NULL, *
+ * noting whether it was mapped rather than read into a buffer       */
+char *load_text(char *path, size_t *len, int *mapped) {
+	char *text;
+	FILE *fp;
+	if ((*mapped = path && (text = map_text(path, len)))) {
+		return text;
+	}
+	if (!path) {
+		fp = stdin;
+	} else if (!(fp = fopen(path, "rb"))) {
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+	text = read_text(fp, len);
+	if (fp != stdin) {
+		fclose(fp);
+	}
+	return text;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Releases text returned by load_text */
+void free_text(char *text, size_t len, int mapped) {
+	if (mapped) {
+		munmap(text, len);
+	} else {
+		free(text);
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Reads all of a stream into a growing buffer, BLOCKSIZE bytes at a time */
+char *read_text(FILE *fp, size_t *len) {
+	size_t lim = BLOCKSIZE, n = NIL, got;
+	char *text = (char *)malloc(lim);
+	assert(text);
+	while ((got = fread(text + n, 1, lim - n, fp)) > NIL) {
+		if ((n += got) == lim) {
+			lim *= 2;
+			text = (char *)realloc(text, lim);
+			assert(text);
+		}
+	}
+	*len = n;
+	return text;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Maps a regular file into memory, returning NULL if it cannot be mapped *
+ * (empty files, pipes and devices are read as streams instead)          */
+char *map_text(char *path, size_t *len) {
+	struct stat st;
+	void *text = MAP_FAILED;
+	int fd = open(path, O_RDONLY);
+	if (fd >= NIL) {
+		if (!fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_size > NIL) {
+			*len = (size_t)st.st_size;
+			text = mmap(NULL, *len, PROT_READ, MAP_PRIVATE, fd, NIL);
+		}
+		close(fd);
+	}
+	return text == MAP_FAILED ? NULL : (char *)text;
+}
+
+/***************************************************************************/
+
+/* Creates a cache holding up to lim results in memory and, if dir is *
+ * not NULL, every result in that directory, which is made if need be */
+cache_t *new_cache(int lim, char *dir) {
+	cache_t *cache = (cache_t *)calloc(1, sizeof(*cache));
+	assert(cache);
+	for (cache->nbuckets = 1; cache->nbuckets < lim; cache->nbuckets *= 2);
+	cache->buckets = (entry_t **)calloc(cache->nbuckets,
+			sizeof(*(cache->buckets)));
+	assert(cache->buckets);
+	cache->lim = lim;
+	cache->dir = dir;
+	if (dir && mkdir(dir, 0777) && errno != EEXIST) {
+		perror(dir);
+		exit(EXIT_FAILURE);
+	}
+	pthread_mutex_init(&cache->lock, NULL);
+	return cache;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Restores a parsed maze from its result, found in memory or else in the *
+ * cache directory, and keeps a result found there in memory. A copy of   *
+ * an entry is taken under the lock, so other workers may drop it while   *
+ * it is unpacked. Returns whether the maze was restored                  */
+int find_result(cache_t *cache, maze_t *maze) {
+	entry_t *entry;
+	uint32_t key = result_key(maze);
+	char *data = NULL, *path;
+	size_t len;
+	int found;
+	pthread_mutex_lock(&cache->lock);
+	if ((entry = find_entry(cache, maze->hash, key))) {
+		touch_entry(cache, entry);
+		data = (char *)arena_alloc(maze->arena, len = entry->len);
+		memcpy(data, entry->data, len);
+	}
+	pthread_mutex_unlock(&cache->lock);
+	if (data) {
+		return unpack_result(maze, data, len);
+	}
+	if (!cache->dir) {
+		return FALSE;
+	}
+	path = result_path(cache, maze, key);
+	if (!(data = map_text(path, &len))) {
+		return FALSE;
+	}
+	if ((found = unpack_result(maze, data, len))) {
+		add_entry(cache, maze->hash, key, data, len);
+	}
+	munmap(data, len);
+	return found;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Packs the result of a traversed maze and keeps it in memory and in the *
+ * cache directory                                                        */
+void keep_result(cache_t *cache, maze_t *maze) {
+	uint32_t key = result_key(maze);
+	size_t len;
+	char *data = pack_result(maze, &len);
+	add_entry(cache, maze->hash, key, data, len);
+	if (cache->dir) {
+		write_result(maze, result_path(cache, maze, key), data, len);
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Returns the entry of a hash and key, or NULL if none is held. The *
+ * caller holds the lock                                             */
+entry_t *find_entry(cache_t *cache, uint64_t hash, uint32_t key) {
+	entry_t *entry = cache->buckets[(hash ^ key) & (cache->nbuckets - 1)];
+	while (entry && (entry->hash != hash || entry->key != key)) {
+		entry = entry->chain;
+	}
+	return entry;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Keeps a copy of a result as the most recently used entry, unless one *
+ * for its hash and key is already held, dropping the least recently    *
+ * used entries beyond the limit                                        */
+void add_entry(cache_t *cache, uint64_t hash, uint32_t key,
+		const char *data, size_t len) {
+	entry_t *entry, **bucket;
+	if (!cache->lim) {
+		return;
+	}
+	pthread_mutex_lock(&cache->lock);
+	if (!find_entry(cache, hash, key)) {
+		entry = (entry_t *)calloc(1, sizeof(*entry));
+		assert(entry);
+		entry->data = (char *)malloc(len);
+		assert(entry->data);
+		memcpy(entry->data, data, entry->len = len);
+		entry->hash = hash;
+		entry->key = key;
+		bucket = cache->buckets + ((hash ^ key) & (cache->nbuckets - 1));
+		entry->chain = *bucket;
+		*bucket = entry;
+		touch_entry(cache, entry);
+		if (++cache->size > cache->lim) {
+			drop_entry(cache, cache->oldest);
+		}
+	}
+	pthread_mutex_unlock(&cache->lock);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Makes an entry, listed or not, the most recently used */
+void touch_entry(cache_t *cache, entry_t *entry) {
+	unlink_entry(cache, entry);
+	entry->older = cache->newest;
+	if (cache->newest) {
+		cache->newest->newer = entry;
+	} else {
+		cache->oldest = entry;
+	}
+	cache->newest = entry;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Takes an entry out of the list of use, if it is in it */
+void unlink_entry(cache_t *cache, entry_t *entry) {
+	if (entry->newer) {
+		entry->newer->older = entry->older;
+	} else if (cache->newest == entry) {
+		cache->newest = entry->older;
+	}
+	if (entry->older) {
+		entry->older->newer = entry->newer;
+	} else if (cache->oldest == entry) {
+		cache->oldest = entry->newer;
+	}
+	entry->newer = entry->older = NULL;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Takes an entry out of the list of use and its bucket and frees it */
+void drop_entry(cache_t *cache, entry_t *entry) {
+	entry_t **link = cache->buckets +
+		((entry->hash ^ entry->key) & (cache->nbuckets - 1));
+	while (*link != entry) {
+		link = &(*link)->chain;
+	}
+	*link = entry->chain;
+	unlink_entry(cache, entry);
+	cache->size--;
+	free(entry->data);
+	free(entry);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Returns the path of a maze's result in the cache directory, cut from *
+ * its arena with room for the suffix of a temporary file               */
+char *result_path(cache_t *cache, maze_t *maze, uint32_t key) {
+	size_t size = strlen(cache->dir) + sizeof(RESNAME) + 24 + sizeof(RESTEMP);
+	char *path = (char *)arena_alloc(maze->arena, size);
+	snprintf(path, size, RESNAME, cache->dir,
+			(unsigned long long)maze->hash, key);
+	return path;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Writes a result to a temporary file and renames it to its path, so *
+ * other runs reading the directory never map a partial result        */
+void write_result(maze_t *maze, char *path, char *data, size_t len) {
+	size_t size = strlen(path);
+	char *temp = (char *)arena_alloc(maze->arena, size + sizeof(RESTEMP));
+	FILE *fp;
+	int fd;
+	memcpy(temp, path, size);
+	memcpy(temp + size, RESTEMP, sizeof(RESTEMP));
+	if ((fd = mkstemp(temp)) < NIL || !(fp = fdopen(fd, "wb"))) {
+		perror(temp);
+		exit(EXIT_FAILURE);
+	}
+	if (fwrite(data, 1, len, fp) != len || fclose(fp) ||
+			rename(temp, path)) {
+		perror(temp);
+		unlink(temp);
+		exit(EXIT_FAILURE);
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Frees memory allocated to a cache and every entry it holds */
+void free_cache(cache_t *cache) {
+	while (cache->oldest) {
+		drop_entry(cache, cache->oldest);
+	}
+	pthread_mutex_destroy(&cache->lock);
+	free(cache->buckets);
+	free(cache);
+}
+
+/***************************************************************************/
+
+/* Serves mazes on the address the options give until SIGINT or SIGTERM. *
+ * The loop accepts connections and reads their requests, each of which  *
+ * a worker solves with a maze of its own, reused request after request, *
+ * before the loop writes the reply back. Workers finish the requests    *
+ * they have before the server stops                                     */
+void serve(opts_t *opts) {
+	server_t server;
+	struct epoll_event ev, events[MAXEVENTS];
+	sigset_t mask;
+	int i, n, run = TRUE;
+	memset(&server, NIL, sizeof(server));
+	server.opts = opts;
+	server.tail = &server.jobs;
+	server.room = sizeof(frame_t) + opts->fmax + READSIZE;
+	server.lfd = listen_on(opts->serve);
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGINT);
+	sigaddset(&mask, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &mask, NULL);
+	if ((server.epfd = epoll_create1(EPOLL_CLOEXEC)) < NIL ||
+			(server.efd = eventfd(NIL, EFD_NONBLOCK | EFD_CLOEXEC)) < NIL ||
+			(server.sfd = signalfd(- 1, &mask, SFD_CLOEXEC)) < NIL) {
+		perror(opts->serve);
+		exit(EXIT_FAILURE);
+	}
+	ev.events = EPOLLIN;
+	ev.data.ptr = &server.lfd;
+	epoll_ctl(server.epfd, EPOLL_CTL_ADD, server.lfd, &ev);
+	ev.data.ptr = &server.efd;
+	epoll_ctl(server.epfd, EPOLL_CTL_ADD, server.efd, &ev);
+	ev.data.ptr = &server.sfd;
+	epoll_ctl(server.epfd, EPOLL_CTL_ADD, server.sfd, &ev);
+	pthread_mutex_init(&server.lock, NULL);
+	pthread_cond_init(&server.ready, NULL);
+	server.nthreads = opts->threads;
+	server.threads = (pthread_t *)calloc(server.nthreads,
+			sizeof(*(server.threads)));
+	assert(server.threads);
+	for (i = NIL; i < server.nthreads; i++) {
+		if (pthread_create(server.threads + i, NULL, serve_worker, &server)) {
+			perror("pthread_create");
+			exit(EXIT_FAILURE);
+		}
+	}
+	while (run) {
+		if ((n = epoll_wait(server.epfd, events, MAXEVENTS, - 1)) < NIL) {
+			if (errno == EINTR) {
+				continue;
+			}
+			perror("epoll_wait");
+			exit(EXIT_FAILURE);
+		}
+		for (i = NIL; i < n; i++) {
+			if (events[i].data.ptr == &server.lfd) {
+				accept_conns(&server);
+			} else if (events[i].data.ptr == &server.efd) {
+				finish_conns(&server);
+			} else if (events[i].data.ptr == &server.sfd) {
+				run = FALSE;
+			} else if (((conn_t *)events[i].data.ptr)->sent <
+					((conn_t *)events[i].data.ptr)->rlen) {
+				write_conn(&server, (conn_t *)events[i].data.ptr);
+			} else {
+				read_conn(&server, (conn_t *)events[i].data.ptr);
+			}
+		}
+	}
+	pthread_mutex_lock(&server.lock);
+	server.stop = TRUE;
+	pthread_cond_broadcast(&server.ready);
+	pthread_mutex_unlock(&server.lock);
+	for (i = NIL; i < server.nthreads; i++) {
+		pthread_join(server.threads[i], NULL);
+	}
+	while (server.conns) {
+		close_conn(&server, server.conns);
+	}
+	if (strchr(opts->serve, '/')) {
+		unlink(opts->serve);
+	}
+	close(server.lfd);
+	close(server.efd);
+	close(server.sfd);
+	close(server.epfd);
+	pthread_mutex_destroy(&server.lock);
+	pthread_cond_destroy(&server.ready);
+	free(server.threads);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Returns a listening socket bound to addr: the path of a Unix socket if *
+ * it holds a slash, which replaces any file there, and otherwise a TCP   *
+ * port, after the host to bind and a colon if it has one                 */
+int listen_on(char *addr) {
+	struct sockaddr_un un;
+	struct addrinfo hints, *res, *ai;
+	char *copy, *port, *colon;
+	int fd = NOTVISIT, on = TRUE, err;
+	if (strchr(addr, '/')) {
+		memset(&un, NIL, sizeof(un));
+		un.sun_family = AF_UNIX;
+		if (strlen(addr) >= sizeof(un.sun_path)) {
+			fprintf(stderr, BADADDR, addr, strerror(ENAMETOOLONG));
+			exit(EXIT_FAILURE);
+		}
+		strcpy(un.sun_path, addr);
+		unlink(addr);
+		if ((fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+				NIL)) < NIL || bind(fd, (struct sockaddr *)&un, sizeof(un)) ||
+				listen(fd, BACKLOG)) {
+			perror(addr);
+			exit(EXIT_FAILURE);
+		}
+		return fd;
+	}
+	copy = port = strdup(addr);
+	assert(copy);
+	if ((colon = strrchr(copy, ':'))) {
+		*colon = '\0';
+		port = colon + 1;
+	}
+	memset(&hints, NIL, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = AI_PASSIVE;
+	if ((err = getaddrinfo(colon && *copy ? copy : NULL, port, &hints, &res))) {
+		fprintf(stderr, BADADDR, addr, gai_strerror(err));
+		exit(EXIT_FAILURE);
+	}
+	for (ai = res; ai && fd == NOTVISIT; ai = ai->ai_next) {
+		if ((fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK |
+				SOCK_CLOEXEC, ai->ai_protocol)) < NIL) {
+			fd = NOTVISIT;
+			continue;
+		}
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+		if (bind(fd, ai->ai_addr, ai->ai_addrlen) || listen(fd, BACKLOG)) {
+			close(fd);
+			fd = NOTVISIT;
+		}
+	}
+	freeaddrinfo(res);
+	free(copy);
+	if (fd == NOTVISIT) {
+		perror(addr);
+		exit(EXIT_FAILURE);
+	}
+	return fd;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Accepts every connection waiting, each watched for requests. Replies *
+ * are written whole, so TCP sockets send them without delay            */
+void accept_conns(server_t *server) {
+	conn_t *conn;
+	int fd, on = TRUE;
+	while ((fd = accept(server->lfd, NULL, NULL)) >= NIL) {
+		fcntl(fd, F_SETFL, O_NONBLOCK);
+		fcntl(fd, F_SETFD, FD_CLOEXEC);
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+		conn = (conn_t *)calloc(1, sizeof(*conn));
+		assert(conn);
+		conn->fd = fd;
+		if ((conn->next = server->conns)) {
+			conn->next->prev = conn;
+		}
+		server->conns = conn;
+		watch_conn(server, conn);
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Reads what has arrived on a connection, at least READSIZE bytes of *
+ * room at a time, and takes a request once one is whole. The buffer  *
+ * grows no further than a frame of the largest size and that room.   *
+ * Closes the connection at its end, on an error, or once its buffer  *
+ * would take the server past BUFFERS of those                        */
+void read_conn(server_t *server, conn_t *conn) {
+	ssize_t got;
+	size_t lim = conn->lim;
+	while (lim - conn->len < READSIZE && lim < server->room) {
+		lim = lim ? lim * 2 : READSIZE;
+		lim = lim < server->room ? lim : server->room;
+	}
+	if (lim != conn->lim) {
+		if (server->held - conn->lim + lim > server->room * BUFFERS) {
+			close_conn(server, conn);
+			return;
+		}
+		server->held += lim - conn->lim;
+		conn->buf = (char *)realloc(conn->buf, conn->lim = lim);
+		assert(conn->buf);
+	}
+	if ((got = recv(conn->fd, conn->buf + conn->len, conn->lim - conn->len,
+			NIL)) > NIL) {
+		conn->len += got;
+		take_request(server, conn);
+	} else if (!got || (errno != EAGAIN && errno != EWOULDBLOCK &&
+			errno != EINTR)) {
+		close_conn(server, conn);
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Queues the first request of a connection for the workers once it is *
+ * whole, unless a request is being solved or a reply written. Closes  *
+ * a connection asking for more than the largest request served        */
+void take_request(server_t *server, conn_t *conn) {
+	frame_t head;
+	size_t len;
+	if (conn->busy || conn->sent < conn->rlen || conn->len < sizeof(head)) {
+		return;
+	}
+	memcpy(&head, conn->buf, sizeof(head));
+	if ((len = ntohl(head.len)) > server->opts->fmax) {
+		close_conn(server, conn);
+		return;
+	}
+	if (conn->len < sizeof(head) + len) {
+		return;
+	}
+	conn->busy = TRUE;
+	watch_conn(server, conn);
+	pthread_mutex_lock(&server->lock);
+	conn->queue = NULL;
+	*server->tail = conn;
+	server->tail = &conn->queue;
+	pthread_cond_signal(&server->ready);
+	pthread_mutex_unlock(&server->lock);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Writes as much of a reply as the socket takes, then watches for the *
+ * rest or, once it is all written, takes the next request. Closes the *
+ * connection on an error                                              */
+void write_conn(server_t *server, conn_t *conn) {
+	ssize_t got;
+	while (conn->sent < conn->rlen) {
+		if ((got = send(conn->fd, conn->reply + conn->sent,
+				conn->rlen - conn->sent, MSG_NOSIGNAL)) >= NIL) {
+			conn->sent += got;
+		} else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+			break;
+		} else if (errno != EINTR) {
+			close_conn(server, conn);
+			return;
+		}
+	}
+	watch_conn(server, conn);
+	take_request(server, conn);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Takes the connections the workers have answered, drops the request *
+ * each answered from its buffer and starts writing its reply         */
+void finish_conns(server_t *server) {
+	frame_t head;
+	conn_t *conn, *done;
+	uint64_t count;
+	size_t size;
+	if (read(server->efd, &count, sizeof(count)) < NIL) {
+		return;
+	}
+	pthread_mutex_lock(&server->lock);
+	done = server->done;
+	server->done = NULL;
+	pthread_mutex_unlock(&server->lock);
+	while ((conn = done)) {
+		done = conn->queue;
+		memcpy(&head, conn->buf, sizeof(head));
+		size = sizeof(head) + ntohl(head.len);
+		conn->len -= size;
+		memmove(conn->buf, conn->buf + size, conn->len);
+		conn->busy = FALSE;
+		write_conn(server, conn);
+	}
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Watches a connection for what it waits on: nothing while a worker has *
+ * it, room to write while a reply is pending and requests otherwise     */
+void watch_conn(server_t *server, conn_t *conn) {
+	struct epoll_event ev;
+	if (conn->busy) {
+		if (conn->watched) {
+			epoll_ctl(server->epfd, EPOLL_CTL_DEL, conn->fd, NULL);
+			conn->watched = FALSE;
+		}
+		return;
+	}
+	ev.events = conn->sent < conn->rlen ? EPOLLOUT : EPOLLIN;
+	ev.data.ptr = conn;
+	if (epoll_ctl(server->epfd, conn->watched ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+			conn->fd, &ev)) {
+		perror("epoll_ctl");
+		exit(EXIT_FAILURE);
+	}
+	conn->watched = TRUE;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Closes a connection and frees memory allocated to it */
+void close_conn(server_t *server, conn_t *conn) {
+	close(conn->fd);
+	if (conn->prev) {
+		conn->prev->next = conn->next;
+	} else {
+		server->conns = conn->next;
+	}
+	if (conn->next) {
+		conn->next->prev = conn->prev;
+	}
+	server->held -= conn->lim;
+	free(conn->buf);
+	free(conn->reply);
+	free(conn);
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Body of a server worker, answering requests with a maze of its own *
+ * until the server stops and no requests are left                    */
+void *serve_worker(void *arg) {
+	server_t *server = (server_t *)arg;
+	maze_t *maze = new_maze();
+	conn_t *conn;
+	uint64_t one = 1;
+	use_opts(maze, server->opts);
+	while (TRUE) {
+		pthread_mutex_lock(&server->lock);
+		while (!server->jobs && !server->stop) {
+			pthread_cond_wait(&server->ready, &server->lock);
+		}
+		if ((conn = server->jobs) && !(server->jobs = conn->queue)) {
+			server->tail = &server->jobs;
+		}
+		pthread_mutex_unlock(&server->lock);
+		if (!conn) {
+			break;
+		}
+		answer_request(server, maze, conn);
+		pthread_mutex_lock(&server->lock);
+		conn->queue = server->done;
+		server->done = conn;
+		pthread_mutex_unlock(&server->lock);
+		if (write(server->efd, &one, sizeof(one)) < NIL) {
+			perror("eventfd");
+		}
+	}
+	free_maze(maze);
+	return NULL;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Solves the first request of a connection and builds its reply: the   *
+ * stages asked for as text, or the result packed, after a header with  *
+ * its length. A request with stages not 1 to 5, an unknown format or a *
+ * malformed binary maze gets an empty reply with status REPLYBAD       */
+void answer_request(server_t *server, maze_t *maze, conn_t *conn) {
+	frame_t head;
+	char *text = conn->buf + sizeof(head), *data = NULL;
+	size_t len;
+	memcpy(&head, conn->buf, sizeof(head));
+	len = ntohl(head.len);
+	if (head.arg & ~ALLSTAGES || head.format > PACKREPLY ||
+			(is_binary(text, len) && !binary_len(text, len))) {
+		head.arg = REPLYBAD;
+		len = NIL;
+	} else {
+		maze->stages = head.arg ? head.arg : server->opts->stages;
+		parse_text(maze, text, len);
+		traverse_cached(maze, server->opts);
+		if (head.format == PACKREPLY) {
+			data = pack_result(maze, &len);
+		} else {
+			maze->out->len = NIL;
+			print_maze(maze);
+			data = maze->out->buf;
+			len = maze->out->len;
+		}
+		head.arg = REPLYOK;
+	}
+	if (sizeof(head) + len > conn->rlim) {
+		conn->rlim = sizeof(head) + len;
+		conn->reply = (char *)realloc(conn->reply, conn->rlim);
+		assert(conn->reply);
+	}
+	head.len = htonl((uint32_t)len);
+	head.spare = NIL;
+	memcpy(conn->reply, &head, sizeof(head));
+	if (len) {
+		memcpy(conn->reply + sizeof(head), data, len);
+	}
+	conn->rlen = sizeof(head) + len;
+	conn->sent = NIL;
+}
+
+/***************************************************************************/
+
+/* Toggles each cell the options ask for in turn, printing the maze again *
+ * after each                                                             */
+void toggle_maze(maze_t *maze, opts_t *opts) {
+	int i;
+	for (i = NIL; i < opts->ntoggles; i++) {
+		toggle_cell(maze, opts->toggles[i * 2], opts->toggles[i * 2 + 1]);
+		out_format(maze->out, TOGGLED, opts->toggles[i * 2],
+				opts->toggles[i * 2 + 1]);
+		print_maze(maze);
+	}
+}
+
+/***************************************************************************/
@@ -0,0 +1,673 @@
+/***************************************************************************/
+
+/* Internal declarations of the bfs library: its constants, the structures *
+ * of a maze and its engines, and the prototypes of every function shared *
+ * between the library and the command line. The public interface is      *
+ * bfs.h; nothing here is stable                                          */
+
+/***************************************************************************/
+
+#ifndef MAZE_H
+#define MAZE_H
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+/* Arena constants. Arrays are aligned to a cache line, and allocations *
+ * beyond the arena's block get blocks of their own of at least SPILL   */
+#define ALIGN    64
+#define SPILL    (1 << 20)
+
+/* Binary maze format. A header, the wall plane in rows of stride words *
+ * with the bits past the last column set, then the columns of the open *
+ * cells of the first and last rows, all in native byte order and the  *
+ * whole padded to a word                                                */
+#define MAGIC    "BFSMAZE1"
+#define MAGICLEN 8
+
+/* Result cache constants. A cached result is a header and a stream of *
+ * bits: runs of open cells of one class, the reach and path flags of  *
+ * each and whether it has a cost, in CLASSBITS bits and the length of *
+ * the run, then the cost of each cell that has one less that of the   *
+ * cell left of it, or else above it, or else the last one coded. Runs *
+ * and costs far from their neighbours are Elias gamma codes. Inputs   *
+ * are hashed with XXH64 and its primes, and so is each result past    *
+ * its first CHECKED bytes, the magic and the hash itself              */
+#define RESULT    "BFSRES02"
+#define CHECKED   (MAGICLEN + sizeof(uint64_t))
+#define CLASSBITS 3
+#define COSTED    0x04
+#define PRIME1    0x9e3779b185ebca87ULL
+#define PRIME2    0xc2b2ae3d27d4eb4fULL
+#define PRIME3    0x165667b19e3779f9ULL
+#define PRIME4    0x85ebca77c2b2ae63ULL
+#define PRIME5    0x27d4eb2f165667c5ULL
+#define ROTL(x, r) ((x) << (r) | (x) >> (64 - (r)))
+
+/* Space reserved in the output buffer for stage headers */
+#define HEADSIZE 256
+
+/* Output forms, named by FORMS in the same order. Text doubles each   *
+ * character of the grids. Runs give each row of a grid as runs of one *
+ * character, a count before each longer than one, and leave out costs *
+ * and Stage 3's grid. Moves print no grids, only the path, as the     *
+ * column of its entrance and a letter of MOVES for each step. Grids   *
+ * in runs are flushed each CHUNK bytes or so                          */
+#define TEXTFORM 0
+#define RUNSFORM 1
+#define MOVEFORM 2
+#define FORMS    {"text", "rle", "moves", NULL}
+#define MOVES    "RDLU"
+#define CHUNK    (1 << 16)
+
+/* Cell character types */
+#define NEWLINE     '\n'
+#define WALL        '#'
+#define PATH        '.'
+#define REACHABLE   '+'
+#define UNREACHABLE '-'
+#define NONSOLUTION ' '
+
+/* Cell flag bits */
+#define OPEN   0x01     /* Cell can be travelled      */
+#define REACH  0x02     /* Reachability of cell       */
+#define SOLN   0x04     /* Part of shortest path      */
+#define PARENT 0x18     /* Direction entered from     */
+#define PSHIFT 3
+#define MARK   0x20     /* Pending in a path rebuild  */
+#define QUEUED 0x40     /* Waiting in a bucket        */
+
+/* Directions water travels, in the order they are tried */
+#define RIGHT 0
+#define DOWN  1
+#define LEFT  2
+#define UP    3
+#define OPPOSITE(dir) (((dir) + 2) % 4)
+
+/* Traversal engines, named by ENGINES in the same order */
+#define QUEUE    0
+#define BITBOARD 1
+#define HYBRID   2
+#define BIDIR    3
+#define PARALLEL 4
+#define TILED    5
+#define ASTAR    6
+#define JPS      7
+#define ENGINES  {"queue", "bitboard", "hybrid", "bidir", "parallel", \
+                  "tiled", "astar", "jps", NULL}
+
+/* Bitboard constants. A level sweeps every word once more than one word *
+ * in DENSE holds frontier cells                                          */
+#define WORDBITS 64
+#define PLANES   4
+#define DENSE    16
+
+/* Hybrid constants. Levels are expanded bottom-up once a growing frontier *
+ * holds more than one in ALPHA unvisited cells, and top-down again once   *
+ * a shrinking one holds fewer than one in BETA open cells                 */
+#define ALPHA    14
+#define BETA     24
+
+/* Parallel constant. Levels with fewer than GRAIN cells per thread are *
+ * expanded by one thread alone                                          */
+#define GRAIN    1024
+
+/* Tile constants. Tiles are TILE cells square, stored one after another */
+#define TILE     64
+#define TILESHIFT 6
+#define TILECELLS (TILE * TILE)
+
+/* Queue constants. The queue engine floods a copy of the open cells, a *
+ * byte each, with a wall row above and below and a wall column after   *
+ * each row, so that no step checks an edge. Mazes 64, 128, 256 or 1024 *
+ * columns wide have floods of their own, KERNEL inlining one body into *
+ * each with the width fixed                                            */
+#define PADDED(cols) ((cols) + 1)
+#if defined(__GNUC__)
+#define KERNEL   inline __attribute__((always_inline))
+#else
+#define KERNEL   inline
+#endif
+
+/* Weighted constants. With -w a digit is an open cell costing that much *
+ * to enter and a path costs one. Costs pending lie within MAXWEIGHT of  *
+ * the lowest, so BUCKETS buckets indexed by cost modulo BUCKETS hold    *
+ * them all                                                              */
+#define MAXWEIGHT 9
+#define BUCKETS  (MAXWEIGHT + 1)
+#define WEIGHT(maze, cell) ((maze)->type[cell] == PATH ? 1 : \
+                            (maze)->type[cell] - '0')
+#define STEP(maze, cell) ((maze)->weighted ? WEIGHT(maze, cell) : 1)
+
+/* Early termination modes, set by -x and -X */
+#define VERDICT  1      /* Stage 2 verdict only       */
+#define REACHED  2      /* Verdict and cells reached  */
+
+/* Instrumentation. Built with -DBFS_STATS, each maze counts the work of *
+ * its solve and the command line times each phase of it; otherwise STAT *
+ * drops the statement it wraps                                          */
+#ifdef BFS_STATS
+#define STAT(stmt) stmt
+#else
+#define STAT(stmt)
+#endif
+
+/* Miscellaneous Constants */
+#define NOTVISIT  - 1
+#define TRUE        1
+#define FALSE       0
+#define NIL         0
+#define LAST_ROW    maze->rows - 1
+#define LAST_COL    maze->cols - 1
+
+/* Index of the cell at row x, column y of a maze */
+#define INDEX(maze, x, y) ((x) * (maze)->cols + (y))
+
+/* Stage numbers. STAGES are printed by default; Stage 5, the costs from *
+ * each entrance to each exit, only when asked for                       */
+#define STAGE1 1
+#define STAGE2 2
+#define STAGE3 3
+#define STAGE4 4
+#define STAGE5 5
+#define STAGES ((1 << STAGE1) | (1 << STAGE2) | (1 << STAGE3) | (1 << STAGE4))
+#define ALLSTAGES (STAGES | 1 << STAGE5)
+
+/* Printing related constants */
+#define STAGENUM "Stage %d\n=======\n"
+#define PRINT1   "maze has %d rows and %d columns\n"
+#define PRINT2A  "maze has a solution\n"
+#define PRINT2B  "maze has no solution\n"
+#define PRINT3A  "maze has a solution with cost %d\n"
+#define PRINT3B  "maze has no solution\n"
+#define PRINT4   "maze solution\n"
+#define PRINT4M  "path from column %d\n"
+#define PRINT5   "maze has %d entrance%s and %d exit%s\n"
+#define PLURAL   "s"
+#define PRINT5X  "exits at"
+#define PRINT5E  "from %d:"
+#define PRINT5C  " %d"
+#define PRINT5N  " -"
+/* Two-digit renderings of the last two digits of a cost */
+#define DIGITS   "00010203040506070809101112131415161718192021222324" \
+                 "25262728293031323334353637383940414243444546474849" \
+                 "50515253545556575859606162636465666768697071727374" \
+                 "75767778798081828384858687888990919293949596979899"
+
+/***************************************************************************/
+
+/* Structure naming convention */
+typedef struct maze_s maze_t;
+typedef struct arena_s arena_t;
+typedef struct queue_s queue_t;
+typedef struct bits_s  bits_t;
+typedef struct level_s level_t;
+typedef struct meet_s  meet_t;
+typedef struct team_s  team_t;
+typedef struct member_s member_t;
+typedef struct tiles_s tiles_t;
+typedef struct tile_s  tile_t;
+typedef struct dial_s  dial_t;
+typedef struct matrix_s matrix_t;
+typedef struct out_s   out_t;
+typedef struct head_s  head_t;
+typedef struct sweep_s sweep_t;
+typedef struct stats_s stats_t;
+typedef struct result_s result_t;
+typedef struct pack_s  pack_t;
+typedef struct band_s  band_t;
+typedef void (*kernel_t)(maze_t *maze);
+
+/* Maze structure */
+struct maze_s {
+	int      rows;  /* Number of rows             */
+	int      cols;  /* Number of columns          */
+	int      cost;  /* Lowest cost of solution    */
+	int      soln;  /* Maze has a solution        */
+	int      stages; /* Bit of each stage printed */
+	int      form;  /* Form stages are printed in */
+	int      partial; /* Only cells near the path were flooded */
+	int      early; /* Stop at the first exit reached */
+	int      threads; /* Threads of parallel engine */
+	int      weighted; /* Digits are cells of that cost */
+	int      solved; /* Traversed since it was parsed */
+	int      exit;  /* Cell the path ends at, or NOTVISIT */
+	int      labelled; /* Traversed by labels alone, with no costs */
+	int     *labels; /* Component of each open cell, or NULL */
+	int      ncomps; /* Number of components      */
+	int      caching; /* Inputs are hashed for the result cache */
+	uint64_t hash;  /* Hash of the input, if caching */
+	int     *dirty; /* Pairs of cell and cost a toggle changed */
+	int      ndirty; /* Number of pairs           */
+	uint8_t *flag;  /* Flag bits of each cell     */
+	int     *costs; /* Cost from nearest entrance */
+	char    *type;  /* Cell visualisation         */
+	const uint64_t *wall; /* Wall plane of a binary maze, read in place */
+	arena_t *arena; /* Memory of the current solve */
+	int      engine; /* Traversal engine used     */
+	queue_t *queue; /* Frontier of the traversal  */
+	kernel_t kernel; /* Flood of queue engine for its width */
+	bits_t  *bits;  /* Planes of bitboard engine  */
+	level_t *level; /* Frontiers of hybrid engine */
+	meet_t  *meet;  /* Exit half of bidirectional engine */
+	team_t  *team;  /* Threads of parallel engine */
+	tiles_t *tiles; /* Planes of tiled engine     */
+	dial_t  *dial;  /* Buckets of weighted floods */
+	matrix_t *matrix; /* Costs between entrances and exits */
+	int      tabled; /* The matrix is of the maze as it stands */
+	out_t   *out;   /* Rendered output            */
+	FILE    *fp;    /* Stream stages are flushed to, if any */
+#ifdef BFS_STATS
+	stats_t *stats; /* Counters of the current solve */
+#endif
+};
+
+/* Arena structure. Memory for one solve, cut from a block by bumping   *
+ * an offset. What the block cannot fit spills into new blocks, and the *
+ * next reset replaces them all with one block as large as the solve    *
+ * asked for, so repeated solves of a size allocate nothing             */
+struct arena_s {
+	char   *base;   /* Block allocations are cut from */
+	size_t  top;    /* Bytes of the block in use  */
+	size_t  lim;    /* Size of the block          */
+	size_t  used;   /* Bytes asked for this solve */
+	void  **blocks; /* Every block allocated      */
+	int     nblocks; /* Number of blocks          */
+	int     blim;   /* Capacity of the block array */
+	int     spilled; /* Blocks were added this solve */
+};
+
+/* Queue structure */
+struct queue_s {
+	int    *cells;  /* Ring buffer of cell indices */
+	int     head;   /* Slot of the first cell     */
+	int     size;   /* Number of queued cells     */
+	int     lim;    /* Capacity of the ring       */
+#ifdef BFS_STATS
+	uint64_t enqueued; /* Cells appended this solve */
+	int     peak;   /* Most cells queued at once  */
+#endif
+};
+
+/* Bitboard structure. Each plane holds a bit per cell, row by row in  *
+ * words of 64 cells with at least one padding bit ending every row,   *
+ * between a guard row and word of zeros on either side. Words are     *
+ * numbered from the first word of the first row. The wall plane, with *
+ * its padding bits set, may be a binary maze's own and is read only   *
+ * within the maze                                                      */
+struct bits_s {
+	const uint64_t *wall; /* Cells that cannot be travelled */
+	uint64_t *seen;   /* Cells reached so far     */
+	uint64_t *front;  /* Cells reached last level */
+	uint64_t *next;   /* Cells reached this level */
+	uint64_t *vals;   /* New cells of each candidate */
+	int      *active; /* Words holding the frontier */
+	int      *cands;  /* Words next to the frontier */
+	int      *stamp;  /* Level a word was last a candidate */
+	int       nactive; /* Number of frontier words */
+	int       words;  /* Words in each row        */
+};
+
+/* Level structure. The frontier of a level is kept in the order the *
+ * queue would hold it, with each cell's position in it as its rank  */
+struct level_s {
+	int    *cells;  /* Frontier of the level      */
+	int    *next;   /* Frontier of the next level */
+	int    *rank;   /* Position of each frontier cell */
+	int    *slots;  /* Next frontier by parent rank and direction */
+	int    *left;   /* Open cells not yet visited */
+	int     size;   /* Number of frontier cells   */
+	int     nleft;  /* Number of cells left, or NOTVISIT if unlisted */
+};
+
+/* Meeting structure. The half of a bidirectional search that starts *
+ * from the exits, a level at a time                                  */
+struct meet_s {
+	int    *costs;  /* Cost to the nearest exit   */
+	int    *cells;  /* Frontier of the level      */
+	int    *next;   /* Frontier of the next level */
+	int     size;   /* Number of frontier cells   */
+	int     depth;  /* Cost of the last level     */
+};
+
+/* Team structure. The threads of the parallel engine sharing the  *
+ * levels of one maze                                              */
+struct team_s {
+	maze_t  *maze;  /* Maze being flooded         */
+	member_t *members; /* One per thread          */
+	int     *counts; /* Next level cells of each thread */
+	int      threads; /* Threads flooding the maze */
+	int      lim;   /* Capacity of the member array */
+	int      cost;  /* Cost of the current level  */
+	int      done;  /* No cells are left to visit */
+	pthread_barrier_t barrier;
+};
+
+/* Member structure. A thread of a team and the cells it claims */
+struct member_s {
+	team_t  *team;  /* Team the thread belongs to */
+	int      id;    /* Index of the thread        */
+	int     *cells; /* Cells claimed this level   */
+	int      size;  /* Number of cells claimed    */
+	int      lim;   /* Capacity of the cell array */
+	pthread_t thread;
+};
+
+/* Tiles structure. The open cells and costs of a maze, tile by tile with *
+ * each tile's cells row by row, and a heap of the tiles waiting to be    *
+ * flooded, least seed cost first. A tile whose least cost falls is       *
+ * pushed again, and the pairs it leaves behind are skipped               */
+struct tiles_s {
+	uint8_t *open;  /* Cells that can be travelled */
+	int     *costs; /* Cost from nearest entrance */
+	tile_t  *tiles; /* Seeds of each tile         */
+	int     *cells; /* Queue of a tile's flood    */
+	int     *heap;  /* Pairs of least seed cost and tile pending */
+	int      nheap; /* Number of pairs in the heap */
+	int      hlim;  /* Capacity of the heap       */
+	int      across; /* Tiles in each row of tiles */
+	int      ntiles; /* Number of tiles           */
+	arena_t *arena; /* Arena seeds grow in        */
+};
+
+/* Tile structure. Cells of a tile given lower costs from beside it, as *
+ * pairs of cell and cost, since the tile was last flooded              */
+struct tile_s {
+	int     *seeds; /* Pairs of cell and cost     */
+	int      nseeds; /* Number of pairs           */
+	int      lim;   /* Capacity of the pair array */
+	int      queued; /* Tile is waiting to be flooded */
+	int      least; /* Lowest cost of its seeds   */
+};
+
+/* Bucket queue structure. Each bucket is a doubly linked list of the   *
+ * cells waiting with one key modulo the number of buckets, in the order *
+ * they were given it. A cell given a lower key moves to the tail of its *
+ * new bucket, so it waits in one bucket at most. Keys waiting must lie  *
+ * within fewer than nbuckets of the lowest. Stacked, cells join the     *
+ * head of a bucket instead, so the last given a key is taken first      */
+struct dial_s {
+	int    *next;   /* Cell after each in its bucket */
+	int    *prev;   /* Cell before each in its bucket */
+	int    *head;   /* First cell of each bucket  */
+	int    *tail;   /* Last cell of each bucket   */
+	int     nbuckets; /* Number of buckets        */
+	int     stacked; /* Cells join bucket heads   */
+	int     size;   /* Number of waiting cells    */
+};
+
+/* Matrix structure. The cost from each entrance to each exit, found    *
+ * WORDBITS entrances at a time by one flood whose cells carry a bit of *
+ * each entrance. Each cell has stride words: the entrances that have   *
+ * reached it, then for each cost modulo nbuckets those due to arrive   *
+ * at it at that cost, with a list of the cells due any. Bits reach a   *
+ * cell first at its lowest cost from their entrance, so the cost they  *
+ * reach an exit at is its cost from that entrance. Bits due at a cell  *
+ * at one cost are taken together however many neighbours pass them on  */
+struct matrix_s {
+	int      *entries; /* Column of each entrance */
+	int      *exits;  /* Column of each exit      */
+	int      *slot;   /* Exit of each column of the last row */
+	int      *costs;  /* Cost from entrance to exit, row by entrance */
+	uint64_t *words;  /* Entrances seen and due in each bucket, by cell */
+	int      *cells[BUCKETS]; /* Cells due any      */
+	int       size[BUCKETS]; /* Number of cells due */
+	int       lim[BUCKETS]; /* Capacity of the arrays */
+	int       nbuckets; /* BUCKETS if weighted, else two */
+	int       stride; /* Words of each cell       */
+	int       nentries; /* Number of entrances    */
+	int       nexits; /* Number of exits          */
+	int       waiting; /* Cells due at any cost   */
+};
+
+/* Output buffer structure */
+struct out_s {
+	char   *buf;    /* Rendered output            */
+	size_t  len;    /* Number of bytes rendered   */
+	size_t  lim;    /* Capacity of the buffer     */
+};
+
+/* Binary maze header */
+struct head_s {
+	char     magic[MAGICLEN]; /* MAGIC, unterminated */
+	uint32_t rows;  /* Number of rows             */
+	uint32_t cols;  /* Number of columns          */
+	uint32_t stride; /* Words in each row of the plane */
+	uint32_t nentries; /* Open cells of the first row */
+	uint32_t nexits; /* Open cells of the last row */
+	uint32_t spare; /* Zero                       */
+};
+
+/* Sweep structure. The last row read and the components of its open   *
+ * cells, labelled by the first cell of each. Labels of the row above   *
+ * are nodes 0 to cols - 1 of the union-find forest and cells of the    *
+ * row being joined to them are nodes cols to 2 * cols - 1              */
+struct sweep_s {
+	char    *line;  /* Line read from the input   */
+	size_t   llim;  /* Capacity of the line       */
+	char    *row;   /* Cells of the row, cols wide */
+	int     *label; /* Component of each cell, or NOTVISIT */
+	int     *parent; /* Union-find forest         */
+	uint8_t *top;   /* Node joins the first row   */
+	uint8_t *keep;  /* Top flags of the new labels */
+	int     *first; /* First cell of each root in the row */
+	int     *stamp; /* Row first was last set in  */
+	int      rows;  /* Number of rows read        */
+	int      cols;  /* Number of columns          */
+};
+
+/* Band structure. Rows first to last - 1 of a maze, whose open cells a *
+ * thread joins into components of the band alone                       */
+struct band_s {
+	maze_t  *maze;  /* Maze being labelled        */
+	int      first; /* First row of the band      */
+	int      last;  /* Row after the band         */
+	pthread_t thread;
+};
+
+/* Cached result header, in native byte order. The maze is named by the *
+ * hash of its input and the options that shape its output by key, and  *
+ * everything after check is covered by it                              */
+struct result_s {
+	char     magic[MAGICLEN]; /* RESULT, unterminated */
+	uint64_t check; /* Hash of the rest of the result */
+	uint64_t hash;  /* Hash of the input          */
+	uint32_t key;   /* Options the maze was solved with */
+	uint32_t rows;  /* Number of rows             */
+	uint32_t cols;  /* Number of columns          */
+	int32_t  cost;  /* Lowest cost of solution    */
+	int32_t  soln;  /* Maze has a solution        */
+	int32_t  partial; /* Only cells near the path were flooded */
+	int32_t  exit;  /* Cell the path ends at, or NOTVISIT */
+	uint32_t size;  /* Bytes of runs that follow  */
+};
+
+/* Pack structure. The bytes of a result as its bits are written, grown *
+ * in an arena, or as they are read back, with the bits of the byte in  *
+ * hand not yet used                                                    */
+struct pack_s {
+	uint8_t *buf;   /* Bytes of the result        */
+	size_t   len;   /* Bytes written, or read so far */
+	size_t   lim;   /* Capacity, or length when read */
+	uint64_t bits;  /* Bits not yet in a byte, or not yet used */
+	int      nbits; /* Number of those bits       */
+	arena_t *arena; /* Arena a written result grows in */
+};
+
+/* Statistics structure. What one solve did, counted as it runs, and how *
+ * long each phase of it took                                           */
+struct stats_s {
+	uint64_t visits; /* Open neighbours stepped to */
+	uint64_t enqueues; /* Cells appended to the queue */
+	uint64_t relaxes; /* Visited cells given a lower cost */
+	int      peak;  /* Most cells queued at once  */
+	size_t   bytes; /* Memory of the solve and its output */
+	double   read_ms; /* Time parsing the text    */
+	double   traverse_ms; /* Time traversing the maze */
+	double   print_ms; /* Time rendering the stages */
+	double   toggle_ms; /* Time toggling cells    */
+};
+
+/***************************************************************************/
+
+/* Library function prototypes */
+int     read_row(arena_t *arena, sweep_t *sweep, FILE *fp);
+int     sweep_row(sweep_t *sweep);
+void    join_nodes(sweep_t *sweep, int a, int b);
+int     find_node(sweep_t *sweep, int node);
+maze_t *new_maze();
+void    new_planes(maze_t *maze);
+arena_t *new_arena();
+void   *arena_alloc(arena_t *arena, size_t size);
+void   *arena_grow(arena_t *arena, void *old, size_t len, size_t size);
+void    reset_arena(arena_t *arena);
+queue_t *new_queue();
+bits_t *new_bits();
+bits_t *reset_bits(maze_t *maze);
+level_t *new_level();
+level_t *reset_level(maze_t *maze);
+meet_t *new_meet();
+meet_t *reset_meet(maze_t *maze);
+team_t *new_team();
+tiles_t *new_tiles();
+tiles_t *reset_tiles(maze_t *maze);
+dial_t *new_dial();
+dial_t *reset_dial(maze_t *maze, int nbuckets, int stacked);
+matrix_t *new_matrix();
+matrix_t *reset_matrix(maze_t *maze);
+int     tile_cell(tiles_t *tiles, int x, int y);
+void    claim_cell(member_t *member, int cell);
+void    reset_queue(queue_t *queue, arena_t *arena, int lim);
+void    enqueue(queue_t *queue, int cell);
+int     dequeue(queue_t *queue);
+maze_t *parse_text(maze_t *maze, char *text, size_t len);
+int     count_rows(char *text, size_t len);
+void    read_rows(maze_t *maze, char *text, size_t len);
+int     is_binary(char *text, size_t len);
+size_t  binary_len(char *text, size_t len);
+void    read_binary(maze_t *maze, char *text);
+void    write_binary(maze_t *maze, FILE *fp);
+maze_t *print_maze(maze_t *maze);
+void    print_stage_1(maze_t *maze, out_t *out);
+void    print_stage_2(maze_t *maze, out_t *out);
+void    print_stage_3(maze_t *maze, out_t *out);
+void    print_stage_4(maze_t *maze, out_t *out);
+void    print_stage_5(maze_t *maze, out_t *out);
+void    print_runs(maze_t *maze, out_t *out, int stage);
+char    run_char(maze_t *maze, int stage, int cell);
+void    print_moves(maze_t *maze, out_t *out);
+char   *print_cost(char *line, int cost);
+char   *print_pair(char *line, char c);
+out_t  *new_out(size_t lim);
+void    reserve_out(out_t *out, size_t lim);
+void    out_format(out_t *out, const char *format, ...);
+char   *out_line(out_t *out, int cols);
+void    flush_out(out_t *out, FILE *fp);
+void    free_out(out_t *out);
+#ifdef BFS_STATS
+void    count_stats(maze_t *maze);
+#endif
+uint64_t hash_text(const char *text, size_t len);
+uint64_t hash_round(uint64_t acc, uint64_t lane);
+uint32_t result_key(maze_t *maze);
+char   *pack_result(maze_t *maze, size_t *len);
+void    pack_costs(maze_t *maze, pack_t *pack);
+int     unpack_result(maze_t *maze, const char *data, size_t len);
+int     unpack_cells(maze_t *maze, pack_t *pack);
+int     unpack_costs(maze_t *maze, pack_t *pack);
+int     cell_class(maze_t *maze, int cell);
+int     cost_ref(maze_t *maze, int cell, int y, int last);
+void    put_bits(pack_t *pack, uint64_t bits, int n);
+void    put_gamma(pack_t *pack, uint64_t value);
+void    put_delta(pack_t *pack, int delta);
+int     get_bits(pack_t *pack, int n, uint64_t *bits);
+int     get_gamma(pack_t *pack, uint64_t *value);
+int     get_delta(pack_t *pack, int *delta);
+maze_t *traverse_maze(maze_t *maze);
+kernel_t pick_kernel(int cols);
+void    flood_maze(maze_t *maze, int cols);
+void    flood_64(maze_t *maze);
+void    flood_128(maze_t *maze);
+void    flood_256(maze_t *maze);
+void    flood_1024(maze_t *maze);
+void    flood_any(maze_t *maze);
+uint8_t *pad_maze(maze_t *maze, int cols);
+int     find_exit(maze_t *maze);
+int     shortest_path(maze_t *maze, int exit);
+int     parent_cell(maze_t *maze, int cell);
+int     next_cell(maze_t *maze, int cell, int dir);
+void    trace_path(maze_t *maze, int exit);
+void    flood_bits(maze_t *maze);
+void    step_sparse(maze_t *maze, bits_t *bits, int cost);
+void    step_dense(maze_t *maze, bits_t *bits, int cost);
+uint64_t expand_word(bits_t *bits, int word);
+void    touch_word(bits_t *bits, int word, int *ncands, int cost);
+void    visit_word(maze_t *maze, bits_t *bits, int word, uint64_t cells,
+		int cost);
+void    flood_hybrid(maze_t *maze);
+void    step_down(maze_t *maze, level_t *level, int cost);
+void    step_up(maze_t *maze, level_t *level, int cost);
+void    list_left(maze_t *maze, level_t *level);
+void    rank_level(level_t *level);
+int     meet_maze(maze_t *maze);
+int     meet_entries(maze_t *maze, level_t *level, meet_t *meet);
+int     meet_exits(maze_t *maze, meet_t *meet);
+void    flood_pruned(maze_t *maze, int cost);
+int     least_left(maze_t *maze, int cell);
+int     star_maze(maze_t *maze);
+int     jump_maze(maze_t *maze);
+int     jump_cell(maze_t *maze, uint8_t *lands, int cell, int dir);
+int     turns_at(maze_t *maze, int next, int cell);
+uint8_t *reset_lands(maze_t *maze);
+int     flood_verdict(maze_t *maze);
+void    label_maze(maze_t *maze);
+void   *label_band(void *arg);
+void    join_cells(int *labels, int a, int b);
+int     find_cell(int *labels, int cell);
+int     reach_labels(maze_t *maze);
+void    reflood_maze(maze_t *maze);
+void    clear_maze(maze_t *maze);
+int     covers_stages(const maze_t *maze, int stages);
+void    cover_stages(maze_t *maze, int stages);
+void    flood_parallel(maze_t *maze);
+void   *run_member(void *arg);
+void    step_team(member_t *member);
+void    flood_tiles(maze_t *maze);
+void    flood_tile(tiles_t *tiles, int tile);
+int     tile_step(tiles_t *tiles, int *tile, int cell, int dir);
+void    seed_cell(tiles_t *tiles, int tile, int cell, int cost);
+int     cmp_seeds(const void *a, const void *b);
+void    push_tile(tiles_t *tiles, int tile, int cost);
+int     pop_tile(tiles_t *tiles);
+void    flood_dial(maze_t *maze);
+void    weigh_cell(maze_t *maze, dial_t *dial, int cell, int cost, int dir);
+int     pop_dial(maze_t *maze, dial_t *dial, int *key);
+void    link_cell(maze_t *maze, dial_t *dial, int cell, int key);
+void    unlink_cell(maze_t *maze, dial_t *dial, int cell, int key);
+void    drain_dial(maze_t *maze, dial_t *dial);
+void    matrix_maze(maze_t *maze);
+void    spread_entries(maze_t *maze, matrix_t *matrix, int base);
+void    due_bits(maze_t *maze, matrix_t *matrix, int cell, uint64_t bits,
+		int bucket);
+int     toggle_cell(maze_t *maze, int x, int y);
+void    open_cell(maze_t *maze, int cell);
+void    close_cell(maze_t *maze, int cell);
+int     supported(maze_t *maze, int cell);
+void    relax_cell(maze_t *maze, int cell);
+void    dirty_cell(maze_t *maze, int cell);
+void    fix_parent(maze_t *maze, int cell);
+void    free_arena(arena_t *arena);
+void    free_queue(queue_t *queue);
+void    free_bits(bits_t *bits);
+void    free_team(team_t *team);
+int     free_maze(maze_t *maze);
+
+#endif
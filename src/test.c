@@ -0,0 +1,647 @@
+/***************************************************************************/
+
+/* Program concept and description :                                       *
+ * Regression tests of the bfs library and of the server of the command    *
+ * line. Each check builds the input it needs in memory, runs it through   *
+ * the functions of bfs.h or sends it to bin/bfs serving on a socket, and  *
+ * reports whether the result is the one expected. A line is written for   *
+ * each check, and the exit status is the number that failed. Run from the *
+ * top of the tree, as make test does                                      */
+
+/***************************************************************************/
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "bfs.h"
+
+/* Binary maze layout, as the library reads it */
+#define MAGIC     "BFSMAZE1"
+#define HEADSIZE  32
+#define WORDBITS  64
+
+/* Server frames, as bin/bfs -D reads and writes them: a header of the *
+ * body's length in network order, a format and an argument, the       *
+ * stages asked for in a request and the status in a reply             */
+#define BFSBIN    "./bin/bfs"
+#define SOCKNAME  "/tmp/bfs-test.%d.sock"
+#define FRAMESIZE 8
+#define REPLYOK   0
+#define REPLYBAD  1
+#define TRIES     200
+
+/* Server limits. Served with -F FRAMECAP, a body of one more byte is  *
+ * refused, and HOLDERS connections each sending most of a frame take *
+ * more buffer than the server holds for all of them                  */
+#define FRAMECAP  4096
+#define HOLDERS   16
+
+/* Result cache. A result is RESULTHEAD bytes of header and then its  *
+ * runs, of which the header's check covers all but the first CHECKED *
+ * bytes; every one of those bytes is flipped in turn                 */
+#define TESTDIR    "/tmp/bfs-test.XXXXXX"
+#define RESULTHEAD 56
+#define CHECKED    16
+#define OUTSIZE    (1 << 16)
+#define MAZETEXT   "#.######\n#......#\n#.##.#.#\n#..#...#\n" \
+                   "##.#.#.#\n#...#..#\n#.#...##\n######.#\n"
+
+/* Random maze the engines solve through bfs.h: a side of GRIDSIZE cells, *
+ * walled at its left and right, each other cell a wall WALLS in a hundred *
+ * times                                                                    */
+#define GRIDSIZE   48
+#define WALLS      30
+#define SEED       1
+#define COSTLINE   "maze has a solution with cost %d\n"
+#define MOVELINE   "path from column "
+
+/* Cells toggled one after another, each then checked against a fresh *
+ * solve of the maze as it now stands                                  */
+#define TOGGLES    64
+
+/* Printing related constants */
+#define PASSED    "ok   %s\n"
+#define FAILED    "FAIL %s\n"
+
+/* Miscellaneous Constants */
+#define NOTVISIT  - 1
+#define TRUE      1
+#define FALSE     0
+#define NIL       0
+
+/***************************************************************************/
+
+/* Structure naming convention */
+typedef struct check_s check_t;
+
+/* Check structure */
+struct check_s {
+	const char *name; /* What the check shows     */
+	int (*run)(void); /* Whether it passed        */
+};
+
+/***************************************************************************/
+
+/* Function prototypes */
+size_t  new_binary(char *buf, uint32_t rows, uint32_t cols, uint32_t stride,
+		uint32_t nentries, uint32_t nexits, size_t len);
+int     check_binary_ok(void);
+int     check_binary_stride(void);
+int     check_binary_wrap(void);
+int     check_binary_ends(void);
+int     check_server_binary(void);
+int     check_server_limits(void);
+pid_t   start_server(char *path, const char *fmax);
+int     connect_server(char *path);
+int     ask_server(int fd, const char *body, size_t len, size_t *size);
+int     read_all(int fd, char *buf, size_t len);
+int     check_cache_corrupt(void);
+size_t  run_bfs(char *args, char *buf, size_t lim);
+size_t  read_file(char *path, char *buf, size_t lim);
+int     write_file(char *path, const char *buf, size_t len);
+int     find_file(char *dir, char *path, size_t lim);
+int     check_api_engines(void);
+size_t  new_grid(char *text);
+int     is_path(const char *text, const int *cells, size_t len);
+int     is_moves(char *out, size_t len, int cost, size_t steps);
+int     check_toggle(void);
+
+/***************************************************************************/
+
+/* Runs every check, reporting each. Writes to a socket the server has *
+ * closed fail rather than raise SIGPIPE                                */
+int main() {
+	const check_t checks[] = {
+		{"binary maze with a row of one more word loads", check_binary_ok},
+		{"binary maze with an oversized stride is malformed",
+			check_binary_stride},
+		{"binary maze whose size would wrap is malformed", check_binary_wrap},
+		{"binary maze with ends past its text is malformed",
+			check_binary_ends},
+		{"server answers a malformed binary maze as bad and keeps serving",
+			check_server_binary},
+		{"server refuses frames past -F and holds bounded request buffers",
+			check_server_limits},
+		{"cached result with a byte flipped is a miss and is rewritten",
+			check_cache_corrupt},
+		{"bidir, astar and jps solve, render and toggle as queue for any stages",
+			check_api_engines},
+		{"toggled cells render stages 1-3 and a path as a fresh solve",
+			check_toggle},
+		{NULL, NULL}
+	};
+	int i, failed = NIL;
+	signal(SIGPIPE, SIG_IGN);
+	for (i = NIL; checks[i].name; i++) {
+		if (checks[i].run()) {
+			printf(PASSED, checks[i].name);
+		} else {
+			printf(FAILED, checks[i].name);
+			failed++;
+		}
+	}
+	return failed;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Writes a binary maze header into buf, then len - HEADSIZE bytes of  *
+ * words with every bit set but the first, which opens the cell at the *
+ * start of every row. Returns len                                     */
+size_t new_binary(char *buf, uint32_t rows, uint32_t cols, uint32_t stride,
+		uint32_t nentries, uint32_t nexits, size_t len) {
+	uint32_t head[6] = {rows, cols, stride, nentries, nexits, NIL};
+	uint64_t word = ~(uint64_t)1;
+	size_t i;
+	memcpy(buf, MAGIC, strlen(MAGIC));
+	memcpy(buf + strlen(MAGIC), head, sizeof(head));
+	for (i = HEADSIZE; i + sizeof(word) <= len; i += sizeof(word)) {
+		memcpy(buf + i, &word, sizeof(word));
+	}
+	return len;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* A maze two rows of one column, each row one word, is a path of cost 1 */
+int check_binary_ok(void) {
+	char buf[HEADSIZE + 2 * sizeof(uint64_t) + sizeof(uint64_t)];
+	uint32_t ends[2] = {NIL, NIL};
+	bfs_t *bfs = bfs_new();
+	int pass;
+	new_binary(buf, 2, 1, 1, 1, 1, sizeof(buf));
+	memcpy(buf + HEADSIZE + 2 * sizeof(uint64_t), ends, sizeof(ends));
+	pass = bfs_load(bfs, buf, sizeof(buf)) == NIL && bfs_solve(bfs) == 1;
+	bfs_free(bfs);
+	return pass;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* 2^30 rows of 2^31 words each wrap to a size that fits in 96 bytes */
+int check_binary_stride(void) {
+	char buf[96];
+	bfs_t *bfs = bfs_new();
+	int pass;
+	new_binary(buf, 1U << 30, 1, 1U << 31, NIL, NIL, sizeof(buf));
+	pass = bfs_load(bfs, buf, sizeof(buf)) == NOTVISIT;
+	bfs_free(bfs);
+	return pass;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* As many rows as rows * cols allows, each a word, need far more than *
+ * the text holds                                                      */
+int check_binary_wrap(void) {
+	char buf[96];
+	bfs_t *bfs = bfs_new();
+	int pass;
+	new_binary(buf, INT32_MAX, 1, 1, NIL, NIL, sizeof(buf));
+	pass = bfs_load(bfs, buf, sizeof(buf)) == NOTVISIT;
+	new_binary(buf, 1U << 26, WORDBITS, 2, NIL, NIL, sizeof(buf));
+	pass = pass && bfs_load(bfs, buf, sizeof(buf)) == NOTVISIT;
+	bfs_free(bfs);
+	return pass;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* A row that fits leaves too few bytes for the columns of its ends */
+int check_binary_ends(void) {
+	char buf[HEADSIZE + 2 * sizeof(uint64_t)];
+	bfs_t *bfs = bfs_new();
+	int pass;
+	new_binary(buf, 1, WORDBITS, 2, WORDBITS, WORDBITS, sizeof(buf));
+	pass = bfs_load(bfs, buf, sizeof(buf)) == NOTVISIT;
+	bfs_free(bfs);
+	return pass;
+}
+
+/***************************************************************************/
+
+/* Sends the server the 96 bytes that once crashed it, then a text maze, *
+ * on one connection and on a new one, expecting REPLYBAD for the first  *
+ * and a rendered maze for each of the others                            */
+int check_server_binary(void) {
+	char path[sizeof(SOCKNAME) + 16], buf[96];
+	const char text[] = "#.#\n#.#\n";
+	size_t size;
+	int fd, pass;
+	pid_t pid;
+	snprintf(path, sizeof(path), SOCKNAME, (int)getpid());
+	if ((pid = start_server(path, NULL)) < NIL) {
+		return FALSE;
+	}
+	new_binary(buf, 1U << 30, 1, 1U << 31, NIL, NIL, sizeof(buf));
+	pass = (fd = connect_server(path)) >= NIL &&
+		ask_server(fd, buf, sizeof(buf), &size) == REPLYBAD && !size &&
+		ask_server(fd, text, strlen(text), &size) == REPLYOK && size;
+	if (fd >= NIL) {
+		close(fd);
+		fd = NOTVISIT;
+	}
+	pass = pass && (fd = connect_server(path)) >= NIL &&
+		ask_server(fd, text, strlen(text), &size) == REPLYOK && size;
+	if (fd >= NIL) {
+		close(fd);
+	}
+	kill(pid, SIGTERM);
+	waitpid(pid, NULL, NIL);
+	unlink(path);
+	return pass;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Serves with a frame cap of FRAMECAP bytes. A body one byte larger     *
+ * closes its connection. HOLDERS connections that each send a header    *
+ * and all but a byte of a FRAMECAP body fill the server's buffers, so a *
+ * request on a new connection is refused while they are open and       *
+ * answered, once they close, as soon as the server has let them go      */
+int check_server_limits(void) {
+	char path[sizeof(SOCKNAME) + 16], cap[16];
+	static char body[FRAMECAP + 1];
+	unsigned char head[FRAMESIZE] = {NIL};
+	const char text[] = "#.#\n#.#\n";
+	struct timespec pause = {0, 50000000};
+	uint32_t n = htonl(FRAMECAP);
+	int fds[HOLDERS], i, fd, pass, answer = NOTVISIT;
+	size_t size;
+	pid_t pid;
+	snprintf(path, sizeof(path), SOCKNAME, (int)getpid());
+	snprintf(cap, sizeof(cap), "%d", FRAMECAP);
+	if ((pid = start_server(path, cap)) < NIL) {
+		return FALSE;
+	}
+	memset(body, '.', sizeof(body));
+	pass = (fd = connect_server(path)) >= NIL &&
+		ask_server(fd, body, sizeof(body), &size) == NOTVISIT;
+	if (fd >= NIL) {
+		close(fd);
+	}
+	memcpy(head, &n, sizeof(n));
+	for (i = NIL; i < HOLDERS; i++) {
+		if ((fds[i] = connect_server(path)) >= NIL) {
+			pass = pass && write(fds[i], head, sizeof(head)) == sizeof(head) &&
+				write(fds[i], body, FRAMECAP - 1) == FRAMECAP - 1;
+		}
+		pass = pass && fds[i] >= NIL;
+	}
+	nanosleep(&pause, NULL);
+	pass = pass && (fd = connect_server(path)) >= NIL &&
+		ask_server(fd, text, strlen(text), &size) == NOTVISIT;
+	if (fd >= NIL) {
+		close(fd);
+	}
+	for (i = NIL; i < HOLDERS; i++) {
+		if (fds[i] >= NIL) {
+			close(fds[i]);
+		}
+	}
+	for (i = NIL; pass && answer != REPLYOK && i < TRIES; i++) {
+		nanosleep(&pause, NULL);
+		if ((fd = connect_server(path)) >= NIL) {
+			answer = ask_server(fd, text, strlen(text), &size);
+			close(fd);
+		}
+	}
+	kill(pid, SIGTERM);
+	waitpid(pid, NULL, NIL);
+	unlink(path);
+	return pass && answer == REPLYOK;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Starts bin/bfs serving on the socket at path, taking requests of at *
+ * most fmax bytes unless it is NULL. Returns its process id, or        *
+ * NOTVISIT if it could not be started                                  */
+pid_t start_server(char *path, const char *fmax) {
+	pid_t pid;
+	unlink(path);
+	if ((pid = fork()) < NIL) {
+		return NOTVISIT;
+	}
+	if (!pid && fmax) {
+		execl(BFSBIN, BFSBIN, "-F", fmax, "-D", path, (char *)NULL);
+		_exit(EXIT_FAILURE);
+	} else if (!pid) {
+		execl(BFSBIN, BFSBIN, "-D", path, (char *)NULL);
+		_exit(EXIT_FAILURE);
+	}
+	return pid;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Connects to the server at path, retrying for a while as it starts. *
+ * Returns the socket, or NOTVISIT                                    */
+int connect_server(char *path) {
+	struct sockaddr_un addr;
+	struct timespec pause = {0, 10000000};
+	int i, fd;
+	memset(&addr, NIL, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+	for (i = NIL; i < TRIES; i++) {
+		if ((fd = socket(AF_UNIX, SOCK_STREAM, NIL)) < NIL) {
+			return NOTVISIT;
+		}
+		if (!connect(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+			return fd;
+		}
+		close(fd);
+		nanosleep(&pause, NULL);
+	}
+	return NOTVISIT;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Sends a request for the default stages as text and reads the reply, *
+ * setting size to the length of its body. Returns the status of the   *
+ * reply, or NOTVISIT if the connection failed                         */
+int ask_server(int fd, const char *body, size_t len, size_t *size) {
+	unsigned char head[FRAMESIZE] = {NIL};
+	uint32_t n = htonl((uint32_t)len);
+	char *reply;
+	int whole;
+	memcpy(head, &n, sizeof(n));
+	if (write(fd, head, sizeof(head)) != sizeof(head) ||
+			write(fd, body, len) != (ssize_t)len ||
+			!read_all(fd, (char *)head, sizeof(head))) {
+		return NOTVISIT;
+	}
+	memcpy(&n, head, sizeof(n));
+	*size = ntohl(n);
+	if (!(reply = (char *)malloc(*size + 1))) {
+		return NOTVISIT;
+	}
+	whole = read_all(fd, reply, *size);
+	free(reply);
+	return whole ? head[5] : NOTVISIT;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Reads exactly len bytes, returning whether they all came */
+int read_all(int fd, char *buf, size_t len) {
+	ssize_t n;
+	while (len) {
+		if ((n = read(fd, buf, len)) <= NIL) {
+			return FALSE;
+		}
+		buf += n;
+		len -= n;
+	}
+	return TRUE;
+}
+
+/***************************************************************************/
+
+/* Solves a maze keeping its result in a cache directory, then flips each *
+ * checked byte of the result in turn and solves it again. Each time the  *
+ * output must be that of the first solve and the result rewritten whole  */
+int check_cache_corrupt(void) {
+	static char first[OUTSIZE], out[OUTSIZE], packed[OUTSIZE], got[OUTSIZE];
+	char dir[] = TESTDIR, maze[sizeof(dir) + 16], cache[sizeof(dir) + 16];
+	char result[OUTSIZE / 64], args[OUTSIZE / 64];
+	size_t len, size, i;
+	int pass;
+	if (!mkdtemp(dir)) {
+		return FALSE;
+	}
+	snprintf(maze, sizeof(maze), "%s/maze.txt", dir);
+	snprintf(cache, sizeof(cache), "%s/cache", dir);
+	snprintf(args, sizeof(args), "-C %s %s", cache, maze);
+	pass = write_file(maze, MAZETEXT, strlen(MAZETEXT)) &&
+		(len = run_bfs(args, first, sizeof(first))) &&
+		find_file(cache, result, sizeof(result)) &&
+		(size = read_file(result, packed, sizeof(packed))) > RESULTHEAD;
+	for (i = CHECKED; pass && i < size; i++) {
+		packed[i] ^= 0x10;
+		pass = write_file(result, packed, size);
+		packed[i] ^= 0x10;
+		pass = pass && run_bfs(args, out, sizeof(out)) == len &&
+			!memcmp(out, first, len) &&
+			read_file(result, got, sizeof(got)) == size &&
+			!memcmp(got, packed, size);
+	}
+	if (find_file(cache, result, sizeof(result))) {
+		unlink(result);
+	}
+	rmdir(cache);
+	unlink(maze);
+	rmdir(dir);
+	return pass;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Runs bin/bfs with args, reading as much of its output as lim allows. *
+ * Returns the length read, or zero if it did not exit cleanly          */
+size_t run_bfs(char *args, char *buf, size_t lim) {
+	char cmd[OUTSIZE / 32];
+	size_t len;
+	FILE *fp;
+	snprintf(cmd, sizeof(cmd), "%s %s", BFSBIN, args);
+	if (!(fp = popen(cmd, "r"))) {
+		return NIL;
+	}
+	len = fread(buf, 1, lim, fp);
+	return pclose(fp) ? NIL : len;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Reads as much of the file at path as lim allows, returning its length */
+size_t read_file(char *path, char *buf, size_t lim) {
+	size_t len;
+	FILE *fp = fopen(path, "rb");
+	if (!fp) {
+		return NIL;
+	}
+	len = fread(buf, 1, lim, fp);
+	fclose(fp);
+	return len;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Replaces the file at path with len bytes, returning whether it did */
+int write_file(char *path, const char *buf, size_t len) {
+	FILE *fp = fopen(path, "wb");
+	int whole;
+	if (!fp) {
+		return FALSE;
+	}
+	whole = fwrite(buf, 1, len, fp) == len;
+	return !fclose(fp) && whole;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Sets path to the first file of a directory not hidden, returning *
+ * whether there was one                                            */
+int find_file(char *dir, char *path, size_t lim) {
+	struct dirent *entry;
+	DIR *dp = opendir(dir);
+	int found = FALSE;
+	if (!dp) {
+		return FALSE;
+	}
+	while (!found && (entry = readdir(dp))) {
+		if (entry->d_name[NIL] != '.') {
+			snprintf(path, lim, "%s/%s", dir, entry->d_name);
+			found = TRUE;
+		}
+	}
+	closedir(dp);
+	return found;
+}
+
+/***************************************************************************/
+
+/* Solves a random maze with the bidirectional and informed engines for  *
+ * each set of stages that changes how far they flood, rendering those    *
+ * stages first. Each must find the cost the queue engine finds, render   *
+ * it and a path as long as Stages 3 and 4 and copy out that path, then   *
+ * find the queue engine's costs as a cell midway along its path is       *
+ * closed and opened again                                                */
+int check_api_engines(void) {
+	const char *engines[] = {"bidir", "astar", "jps", NULL};
+	const int stages[] = {BFS_STAGES, BFS_STAGE2, BFS_STAGE3, BFS_STAGE4,
+		BFS_STAGE3 | BFS_STAGE4, NIL};
+	static char text[(GRIDSIZE + 1) * GRIDSIZE], out[OUTSIZE];
+	static int cells[GRIDSIZE * GRIDSIZE];
+	size_t len = new_grid(text), lim = GRIDSIZE * GRIDSIZE, steps;
+	int i, j, x, y, cost, toggled, pass;
+	bfs_t *bfs = bfs_new();
+	pass = bfs_load(bfs, text, len) == NIL && (cost = bfs_solve(bfs)) > NIL &&
+		bfs_form(bfs, "moves") == NIL;
+	steps = bfs_path(bfs, cells, lim);
+	x = steps ? cells[steps / 2] / GRIDSIZE : NIL;
+	y = steps ? cells[steps / 2] % GRIDSIZE : NIL;
+	toggled = bfs_toggle(bfs, x, y);
+	pass = pass && steps && bfs_toggle(bfs, x, y) == cost;
+	for (i = NIL; pass && engines[i]; i++) {
+		for (j = NIL; pass && stages[j]; j++) {
+			bfs_stages(bfs, stages[j]);
+			pass = bfs_engine(bfs, engines[i]) == NIL &&
+				bfs_load(bfs, text, len) == NIL;
+			bfs_render(bfs, stages[j], out, OUTSIZE);
+			pass = pass && bfs_solve(bfs) == cost && is_moves(out,
+				bfs_render(bfs, BFS_STAGE3 | BFS_STAGE4, out, OUTSIZE),
+				cost, steps);
+			pass = pass && bfs_path(bfs, cells, lim) == steps &&
+				is_path(text, cells, steps);
+			pass = pass && bfs_toggle(bfs, x, y) == toggled &&
+				bfs_toggle(bfs, x, y) == cost;
+		}
+	}
+	bfs_free(bfs);
+	return pass;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Writes the rows of a random maze into text, the same one each time. *
+ * Returns its length                                                  */
+size_t new_grid(char *text) {
+	size_t x, y, i = NIL;
+	srand(SEED);
+	for (x = NIL; x < GRIDSIZE; x++) {
+		for (y = NIL; y < GRIDSIZE; y++) {
+			text[i++] = !y || y == GRIDSIZE - 1 ||
+				rand() % 100 < WALLS ? '#' : '.';
+		}
+		text[i++] = '\n';
+	}
+	return i;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Whether cells run from the top row of a maze's text to its bottom row, *
+ * each open and each a step from the last                                */
+int is_path(const char *text, const int *cells, size_t len) {
+	size_t i;
+	int step;
+	if (!len || cells[NIL] >= GRIDSIZE ||
+			cells[len - 1] < GRIDSIZE * (GRIDSIZE - 1)) {
+		return FALSE;
+	}
+	for (i = NIL; i < len; i++) {
+		if (text[cells[i] / GRIDSIZE * (GRIDSIZE + 1) +
+				cells[i] % GRIDSIZE] != '.') {
+			return FALSE;
+		}
+		step = i ? abs(cells[i] - cells[i - 1]) : GRIDSIZE;
+		if (step != GRIDSIZE && (step != 1 ||
+				cells[i] / GRIDSIZE != cells[i - 1] / GRIDSIZE)) {
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Toggles random cells of a random maze one after another. After each, *
+ * Stages 1 to 3 must render as a fresh solve of the maze as it stands  *
+ * renders them, and the path must be as long, though where shortest    *
+ * paths tie it may run another way                                     */
+int check_toggle(void) {
+	const int stages = BFS_STAGE1 | BFS_STAGE2 | BFS_STAGE3;
+	static char text[(GRIDSIZE + 1) * GRIDSIZE];
+	static char got[OUTSIZE], want[OUTSIZE];
+	static int cells[GRIDSIZE * GRIDSIZE];
+	size_t len = new_grid(text), lim = GRIDSIZE * GRIDSIZE, steps, size;
+	int i, x, y, cost, pass;
+	bfs_t *bfs = bfs_new(), *fresh = bfs_new();
+	pass = bfs_load(bfs, text, len) == NIL && bfs_solve(bfs) > NIL;
+	for (i = NIL; pass && i < TOGGLES; i++) {
+		x = rand() % GRIDSIZE;
+		y = rand() % GRIDSIZE;
+		text[x * (GRIDSIZE + 1) + y] ^= '#' ^ '.';
+		cost = bfs_toggle(bfs, x, y);
+		pass = bfs_load(fresh, text, len) == NIL &&
+			bfs_solve(fresh) == cost;
+		size = bfs_render(bfs, stages, got, OUTSIZE);
+		pass = pass && size == bfs_render(fresh, stages, want, OUTSIZE) &&
+			!memcmp(got, want, size);
+		steps = bfs_path(fresh, cells, lim);
+		pass = pass && bfs_path(bfs, cells, lim) == steps &&
+			(!steps || is_path(text, cells, steps));
+	}
+	bfs_free(bfs);
+	bfs_free(fresh);
+	return pass;
+}
+
+/**^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^**/
+
+/* Whether Stages 3 and 4 rendered as moves give a cost and then a move *
+ * for each step of a path of that many cells                           */
+int is_moves(char *out, size_t len, int cost, size_t steps) {
+	char line[OUTSIZE / 64], *moves;
+	out[len < OUTSIZE ? len : OUTSIZE - 1] = '\0';
+	snprintf(line, sizeof(line), COSTLINE, cost);
+	if (!strstr(out, line) || !(moves = strstr(out, MOVELINE)) ||
+			!(moves = strchr(moves, '\n'))) {
+		return FALSE;
+	}
+	return strcspn(moves + 1, "\n") == steps - 1;
+}
+
+/***************************************************************************/